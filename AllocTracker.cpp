@@ -0,0 +1,140 @@
+// AllocTracker.cpp — global operator new/delete hooks (see AllocTracker.h)
+
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> g_enabled{ false };
+thread_local bool t_isMain = false;
+
+// main thread only: plain counters, no atomics on the hot path
+alloc::Phase g_phase = alloc::Phase::Events;
+alloc::FrameAllocs g_frame;
+
+// everyone else
+std::atomic<std::uint64_t> g_bgAllocs{ 0 }, g_bgFrees{ 0 }, g_bgBytes{ 0 };
+
+inline void noteAlloc(std::size_t n) {
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    if (t_isMain) {
+        auto& c = g_frame.phase[static_cast<std::size_t>(g_phase)];
+        ++c.allocs; c.bytes += n;
+    }
+    else {
+        g_bgAllocs.fetch_add(1, std::memory_order_relaxed);
+        g_bgBytes.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+inline void noteFree(void* p) {
+    if (!p || !g_enabled.load(std::memory_order_relaxed)) return;
+    if (t_isMain) ++g_frame.phase[static_cast<std::size_t>(g_phase)].frees;
+    else g_bgFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* allocOrNull(std::size_t n) {
+    noteAlloc(n);
+    return std::malloc(n ? n : 1);
+}
+
+void* allocOrThrow(std::size_t n) {
+    for (;;) {
+        if (void* p = allocOrNull(n)) return p;
+        std::new_handler h = std::get_new_handler();
+        if (!h) throw std::bad_alloc();
+        h();
+    }
+}
+
+void* alignedAlloc(std::size_t n, std::size_t align) {
+    noteAlloc(n);
+#ifdef _WIN32
+    return _aligned_malloc(n ? n : 1, align);
+#else
+    void* p = nullptr;
+    if (align < sizeof(void*)) align = sizeof(void*);
+    return posix_memalign(&p, align, n ? n : 1) == 0 ? p : nullptr;
+#endif
+}
+
+void alignedFree(void* p) {
+    noteFree(p);
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+namespace alloc {
+
+Counts FrameAllocs::total() const {
+    Counts t;
+    for (const Counts& c : phase) { t.allocs += c.allocs; t.frees += c.frees; t.bytes += c.bytes; }
+    return t;
+}
+
+void attachMainThread() { t_isMain = true; }
+void setEnabled(bool on) { g_enabled.store(on, std::memory_order_relaxed); }
+bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+void setPhase(Phase p) { g_phase = p; }
+
+const char* phaseName(Phase p) {
+    switch (p) {
+    case Phase::Events:     return "events";
+    case Phase::Update:     return "update";
+    case Phase::Trace:      return "trace";
+    case Phase::Draw:       return "draw";
+    case Phase::Hud:        return "hud";
+    case Phase::Background: return "background";
+    default:                return "?";
+    }
+}
+
+FrameAllocs endFrame() {
+    FrameAllocs out = g_frame;
+    g_frame = FrameAllocs{};
+    auto& bg = out.phase[static_cast<std::size_t>(Phase::Background)];
+    bg.allocs = g_bgAllocs.exchange(0, std::memory_order_relaxed);
+    bg.frees = g_bgFrees.exchange(0, std::memory_order_relaxed);
+    bg.bytes = g_bgBytes.exchange(0, std::memory_order_relaxed);
+    return out;
+}
+
+} // namespace alloc
+
+// ---------- replaced global allocation functions ----------
+void* operator new(std::size_t n) { return allocOrThrow(n); }
+void* operator new[](std::size_t n) { return allocOrThrow(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return allocOrNull(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return allocOrNull(n); }
+
+void operator delete(void* p) noexcept { noteFree(p); std::free(p); }
+void operator delete[](void* p) noexcept { noteFree(p); std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { noteFree(p); std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { noteFree(p); std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { noteFree(p); std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { noteFree(p); std::free(p); }
+
+void* operator new(std::size_t n, std::align_val_t a) {
+    if (void* p = alignedAlloc(n, static_cast<std::size_t>(a))) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t a) {
+    if (void* p = alignedAlloc(n, static_cast<std::size_t>(a))) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return alignedAlloc(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return alignedAlloc(n, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
@@ -0,0 +1,41 @@
+// AllocTracker.h — counts heap allocations per frame and per main-loop phase
+//
+// AllocTracker.cpp replaces the global operator new/delete. The hooks are
+// always linked but only count while enabled (one branch per call otherwise).
+// Allocations on the main thread are attributed to the current phase; all
+// other threads (rebuild workers etc.) land in Background. Hud is the
+// tracker's own readout refresh, kept apart so it is not billed to the frame.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace alloc {
+
+enum class Phase : std::uint8_t { Events, Update, Trace, Draw, Hud, Background, Count };
+constexpr std::size_t kPhases = static_cast<std::size_t>(Phase::Count);
+
+struct Counts {
+    std::uint64_t allocs = 0;
+    std::uint64_t frees = 0;
+    std::uint64_t bytes = 0;   // requested bytes (frees are not sized)
+};
+
+struct FrameAllocs {
+    Counts phase[kPhases];
+    Counts total() const;
+};
+
+// Call once from the thread whose phases you want broken down.
+void attachMainThread();
+
+void setEnabled(bool on);
+bool enabled();
+
+void setPhase(Phase p);
+const char* phaseName(Phase p);
+
+// Returns the counts since the previous call and starts a new frame.
+FrameAllocs endFrame();
+
+} // namespace alloc
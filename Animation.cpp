@@ -0,0 +1,127 @@
+// Animation.cpp — timelines and the headless animation run (see Animation.h)
+
+#include "Animation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "ExportJobs.h"
+#include "Spirograph.h"
+
+namespace {
+
+bool paramByName(const std::string& s, Track::Param& out) {
+    if (s == "base")   { out = Track::Param::Base;   return true; }
+    if (s == "speed")  { out = Track::Param::Speed;  return true; }
+    if (s == "radius") { out = Track::Param::Radius; return true; }
+    if (s == "offset") { out = Track::Param::Offset; return true; }
+    if (s == "phase")  { out = Track::Param::Phase;  return true; }
+    return false;
+}
+
+} // namespace
+
+float Track::at(double u) const {
+    if (keys.empty()) return 0.f;
+    if (u <= keys.front().u) return keys.front().value;
+    if (u >= keys.back().u) return keys.back().value;
+    const auto hi = std::upper_bound(keys.begin(), keys.end(), u, [](double v, const Key& k) { return v < k.u; });
+    const auto lo = hi - 1;
+    const double w = hi->u > lo->u ? (u - lo->u) / (hi->u - lo->u) : 1.0;
+    return static_cast<float>(lo->value + (hi->value - lo->value) * w);
+}
+
+void Timeline::apply(double u, float& R, std::vector<Stage>& chain) const {
+    for (const Track& tr : tracks) {
+        const float v = tr.at(u);
+        if (tr.param == Track::Param::Base) { R = v; continue; }
+        if (tr.stage < 0 || tr.stage >= static_cast<int>(chain.size())) continue;
+        Stage& s = chain[tr.stage];
+        switch (tr.param) {
+        case Track::Param::Speed:  s.speed = v; break;
+        case Track::Param::Radius: s.r = v; break;
+        case Track::Param::Offset: s.d = v; break;
+        case Track::Param::Phase:  s.phase = v; break;
+        default: break;
+        }
+    }
+}
+
+bool loadTimeline(std::istream& in, Timeline& out, float& R, std::vector<Stage>& chain, std::string& error) {
+    Timeline tl;
+    float fileR = R;
+    std::vector<Stage> fileChain;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ls(line);
+        std::string word;
+        if (!(ls >> word)) continue;
+
+        auto fail = [&](const std::string& what) {
+            error = "line " + std::to_string(lineNo) + ": " + what;
+            return false;
+        };
+
+        Track tr;
+        std::string what;
+        if (readChainLine(word, ls, fileR, fileChain, what)) {
+            if (!what.empty()) return fail(what);
+        }
+        else if (word == "frames") {
+            if (!(ls >> tl.frames) || tl.frames < 1) return fail("bad frame count");
+        }
+        else if (word == "seconds") {
+            if (!(ls >> tl.seconds) || tl.seconds < 0.0) return fail("bad seconds");
+        }
+        else if (paramByName(word, tr.param)) {
+            if (tr.param != Track::Param::Base && !(ls >> tr.stage)) return fail("missing stage");
+            std::vector<double> nums;
+            for (double v; ls >> v;) nums.push_back(v);
+            if (nums.empty() || nums.size() % 2 || !ls.eof()) return fail("keys are <u> <value> pairs");
+            for (std::size_t i = 0; i < nums.size(); i += 2) tr.keys.push_back({ nums[i], static_cast<float>(nums[i + 1]) });
+            std::stable_sort(tr.keys.begin(), tr.keys.end(), [](const Track::Key& a, const Track::Key& b) { return a.u < b.u; });
+            tl.tracks.push_back(std::move(tr));
+        }
+        else return fail("unknown keyword '" + word + "'");
+    }
+
+    out = std::move(tl);
+    if (!fileChain.empty()) { R = fileR; chain = std::move(fileChain); }
+    return true;
+}
+
+int runAnimation(const AnimateOptions& opts) {
+    std::ifstream in(opts.timeline);
+    if (!in) {
+        std::cerr << "cannot open " << opts.timeline << "\n";
+        return 2;
+    }
+    float R = 200.f;
+    std::vector<Stage> chain = defaultChain(R);
+    Timeline timeline;
+    std::string error;
+    if (!loadTimeline(in, timeline, R, chain, error)) {
+        std::cerr << opts.timeline << ": " << error << "\n";
+        return 2;
+    }
+
+    TraceStyle style;   // the tracer's defaults
+    style.center = { kLogicalW * 0.5f, kLogicalH * 0.5f };
+    const sf::Vector2u size{ static_cast<unsigned>(kLogicalW * opts.scale), static_cast<unsigned>(kLogicalH * opts.scale) };
+    AnimationJob job(opts.prefix, R, std::move(chain), std::move(timeline), size, opts.scale, style,
+        kMaxCurveSeconds, opts.threads);
+
+    std::cout << "animating " << opts.timeline << " on " << job.threads() << " threads\n";
+    std::string shown;
+    while (!job.step(Job::Clock::now() + std::chrono::milliseconds(50))) {
+        if (job.label() != shown) std::cout << "\r" << (shown = job.label()) << std::flush;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::cout << "\r" << job.result() << "\n";
+    return job.failed() > 0 ? 1 : 0;
+}
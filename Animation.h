@@ -0,0 +1,62 @@
+// Animation.h — keyframed parameter timelines for offline animation renders
+//
+// Every frame of an animation is a whole figure (one period of the chain, or
+// a fixed number of seconds) traced from scratch with the parameters the
+// timeline gives at that frame, so frames are independent: AnimationJob
+// (ExportJobs.h) renders them on worker threads and writes them in order.
+//
+// Timeline file: optionally the chain first, in the chain export format
+// ("R <radius>", "stage <level> <r> <d> <outside> <speed> <phase>"), then
+//     frames <N>                  frame count (default 120)
+//     seconds <S>                 trace S seconds per frame (default 0: one period)
+//     <param> <stage> <u> <v> ... keys: value v at u = 0..1 through the animation
+//     base <u> <v> ...            keys for R
+// where param is speed, radius, offset or phase and stage counts from 0.
+// Values between keys are interpolated linearly; before the first and after
+// the last key they hold. '#' starts a comment.
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct Stage;
+
+struct Track {
+    enum class Param { Base, Speed, Radius, Offset, Phase };
+    struct Key { double u; float value; };
+
+    Param param = Param::Speed;
+    int   stage = 0;
+    std::vector<Key> keys;   // sorted by u
+
+    float at(double u) const;
+};
+
+struct Timeline {
+    int    frames = 120;
+    double seconds = 0.0;
+    std::vector<Track> tracks;
+
+    // u of a frame: 0 at the first, 1 at the last.
+    double frameU(int frame) const { return frames > 1 ? static_cast<double>(frame) / (frames - 1) : 0.0; }
+
+    // Writes the animated parameters at u over R and the chain. Tracks for
+    // stages the chain does not have are ignored.
+    void apply(double u, float& R, std::vector<Stage>& chain) const;
+};
+
+// Reads a timeline file; the chain lines, if any, replace R and chain.
+bool loadTimeline(std::istream& in, Timeline& out, float& R, std::vector<Stage>& chain, std::string& error);
+
+// --animate FILE: renders the timeline headless and exits.
+struct AnimateOptions {
+    std::string timeline;            // empty = off
+    std::string prefix = "anim_";    // frames go to <prefix>00000.png, ...
+    unsigned    threads = 0;         // 0 = one per core
+    float       scale = 1.f;         // PNG pixels per logical pixel
+};
+
+// Returns the process exit code: 0 = every frame written, 1 = some failed,
+// 2 = the timeline could not be read.
+int runAnimation(const AnimateOptions& opts);
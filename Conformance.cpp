@@ -0,0 +1,315 @@
+// Conformance.cpp — evaluator cross-check (see Conformance.h)
+
+#include "Conformance.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Nco.h"
+#include "Spirograph.h"
+
+namespace {
+
+constexpr std::size_t kSamples = 256;   // per chain, on a uniform time grid
+
+struct Case {
+    float R = 200.f;
+    std::vector<Stage> chain;
+    CompiledChain compiled;
+    NcoChain nco;
+    double t0 = 0.0, dt = 0.0;
+    std::uint64_t tick0 = 0, dTick = 1;   // the same grid, on the NCO tick clock
+    ColorParams color;                    // motion colouring mode for the hue variants
+};
+
+// The time a variant is actually handed for sample k.
+enum class TimeKind { Double, Float, Tick };
+
+double sampleTime(const Case& c, TimeKind kind, std::size_t k) {
+    const double t = c.t0 + c.dt * k;
+    switch (kind) {
+    case TimeKind::Float: return static_cast<float>(t);
+    case TimeKind::Tick:  return static_cast<double>(c.tick0 + c.dTick * k) / NcoChain::kTickHz;
+    default:              return t;
+    }
+}
+
+// What a variant's output is checked as: the pen, its analytic first or
+// second time derivative, or the motion-colour hue index (in `hue`, checked
+// against motionHueIndex of the reference derivatives, in palette steps
+// round the hue circle).
+enum class Quantity { Pen, Velocity, Acceleration, Hue };
+
+// A variant passes while |out - reference| <= maxErrPx + maxUlps * floatUlps(t)
+// + maxRel * scale at every sample. floatUlps is the pixel error one float
+// rounding of each term's angle and length would cause, so float evaluators
+// get a bound that grows with |omega t| exactly as their precision shrinks,
+// while double evaluators (maxUlps = 0) are held to a fixed pixel bound.
+// scale is sum |amp| |omega|^order for a derivative of that order (its largest
+// possible magnitude), 0 for the pen.
+struct Variant {
+    const char* name;
+    double maxErrPx;
+    double maxUlps;
+    double maxRel;
+    TimeKind time;     // compared against the reference at the time it was handed
+    Quantity what;
+    std::function<void(const Case&, std::vector<sf::Vector2f>&, std::vector<std::uint8_t>&)> eval;
+};
+
+// The variants under test. Each fills out[k] with its quantity at t0 + k*dt.
+std::vector<Variant> variants() {
+    return {
+        // double inside since the scalar path moved off float, so held to the
+        // double evaluators' fixed bound; handed a float t as before
+        { "scalar", 1e-3, 0.0, 0.0, TimeKind::Float, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            for (std::size_t k = 0; k < out.size(); ++k)
+                out[k] = penAtTime(c.R, c.chain, static_cast<float>(c.t0 + c.dt * k));
+            } },
+        { "compiled", 1e-3, 0.0, 0.0, TimeKind::Double, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            for (std::size_t k = 0; k < out.size(); ++k)
+                out[k] = evalPen(c.compiled, c.t0 + c.dt * k);
+            } },
+        { "batch-rotation", 1e-3, 0.0, 0.0, TimeKind::Double, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            evalPenBatch(c.compiled, c.t0, c.dt, out.size(), out.data());
+            } },
+        { "batch-derivs", 1e-3, 0.0, 0.0, TimeKind::Double, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            std::vector<sf::Vector2f> vel(out.size()), acc(out.size());
+            evalPenBatch(c.compiled, c.t0, c.dt, out.size(), out.data(), vel.data(), acc.data());
+            } },
+        { "batch-derivs-vel", 1e-3, 0.0, 1e-6, TimeKind::Double, Quantity::Velocity, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            std::vector<sf::Vector2f> pos(out.size()), acc(out.size());
+            evalPenBatch(c.compiled, c.t0, c.dt, out.size(), pos.data(), out.data(), acc.data());
+            } },
+        { "batch-derivs-acc", 1e-3, 0.0, 1e-6, TimeKind::Double, Quantity::Acceleration, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            std::vector<sf::Vector2f> pos(out.size()), vel(out.size());
+            evalPenBatch(c.compiled, c.t0, c.dt, out.size(), pos.data(), vel.data(), out.data());
+            } },
+        { "batch-hue", 1e-3, 0.0, 0.0, TimeKind::Double, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>& hue) {
+            evalPenBatch(c.compiled, c.t0, c.dt, out.size(), out.data(), hue.data(), c.color, 0.f);
+            } },
+        { "batch-hue-index", 1.0, 0.0, 0.0, TimeKind::Double, Quantity::Hue, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>& hue) {
+            evalPenBatch(c.compiled, c.t0, c.dt, out.size(), out.data(), hue.data(), c.color, 0.f);
+            } },
+        { "nco", 1e-3, 0.0, 0.0, TimeKind::Tick, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            for (std::size_t k = 0; k < out.size(); ++k)
+                out[k] = evalPenNco(c.nco, c.tick0 + c.dTick * k);
+            } },
+        { "nco-batch", 1e-3, 0.0, 0.0, TimeKind::Tick, Quantity::Pen, [](const Case& c, std::vector<sf::Vector2f>& out, std::vector<std::uint8_t>&) {
+            evalPenNcoBatch(c.nco, c.tick0, c.dTick, out.size(), out.data());
+            } },
+    };
+}
+
+// nestedPenAndCenters_perStageSpeed, carried out in long double, with its
+// first and second time derivatives: q[0] pen, q[1] velocity, q[2] acceleration.
+struct RefPoint { long double x[3], y[3]; };
+
+void referencePen(const Case& c, long double t, RefPoint& q) {
+    for (int k = 0; k < 3; ++k) q.x[k] = q.y[k] = 0.0L;
+    // (ax cos theta, ay sin theta) with theta' = w
+    auto add = [&q](long double ax, long double ay, long double theta, long double w) {
+        const long double cs = std::cos(theta), sn = std::sin(theta);
+        q.x[0] += ax * cs;          q.y[0] += ay * sn;
+        q.x[1] -= ax * sn * w;      q.y[1] += ay * cs * w;
+        q.x[2] -= ax * cs * w * w;  q.y[2] -= ay * sn * w * w;
+    };
+    long double baseRadius = c.R;
+    for (std::size_t j = 0; j < c.chain.size(); ++j) {
+        const Stage& s = c.chain[j];
+        const long double speed = s.speed;
+        const long double alpha = speed * t + s.phase;
+        const long double kappa = s.outside ? (baseRadius + s.r) : (baseRadius - s.r);
+        add(kappa, kappa, alpha, speed);
+        if (j + 1 == c.chain.size()) {
+            const long double ratio = kappa / s.r;
+            add(s.outside ? -s.d : s.d, -s.d, ratio * alpha, ratio * speed);
+        }
+        else {
+            baseRadius = s.r;
+        }
+    }
+}
+
+const char* unitName(Quantity what) {
+    switch (what) {
+    case Quantity::Velocity:     return "px/s";
+    case Quantity::Acceleration: return "px/s^2";
+    case Quantity::Hue:          return "steps";
+    default:                     return "px";
+    }
+}
+
+double derivScale(const CompiledChain& c, Quantity what) {
+    if (what == Quantity::Pen || what == Quantity::Hue) return 0.0;
+    double s = 0.0;
+    for (const auto& term : c.terms) {
+        const double w = std::fabs(term.omega);
+        s += std::fabs(term.amp) * (what == Quantity::Velocity ? w : w * w);
+    }
+    return s;
+}
+
+double floatUlps(const CompiledChain& c, double t) {
+    constexpr double kHalfUlp = 5.9604644775390625e-8;   // 2^-24
+    double px = 0.0;
+    for (const auto& term : c.terms)
+        px += std::fabs(term.amp) * (std::fabs(term.omega * t + term.phase) + 1.0);
+    return px * kHalfUlp;
+}
+
+// Built straight from mt19937 output (whose sequence the standard fixes) so a
+// seed gives the same chains with every standard library; the distributions
+// are implementation-defined, which would make the NCO checksum meaningless.
+// (Builds that contract a*b+c into FMA also generate slightly different
+// chains; compare checksums between builds without FP contraction.)
+Case randomCase(std::mt19937& rng) {
+    auto u01 = [&rng] { return static_cast<float>(rng() >> 8) * 5.9604644775390625e-8f; };   // [0,1), 2^-24 steps
+    Case c;
+    c.R = 50.f + 250.f * u01();
+
+    const int n = static_cast<int>(rng() % 16) + 1;
+    const bool powerSpeeds = u01() < 0.3f;   // the default chain's (-4)^i
+    float base = c.R;
+    float power = 1.f;
+    for (int i = 0; i < n; ++i) {
+        // one u01() per statement: operand evaluation order is unspecified
+        const bool outside = u01() < 0.5f;
+        const float r = base * (0.15f + 0.7f * u01());
+        float speed = power;
+        if (!powerSpeeds) {
+            speed = u01() * 2.f - 1.f;
+            speed *= u01() < 0.2f ? 2000.f : 20.f;
+        }
+        if (i < 9) power *= -4.f;
+        const float phase = (u01() * 2.f - 1.f) * 3.14159f;
+        c.chain.emplace_back(i + 1, r, 0.f, outside, speed, phase);
+        base = r;
+    }
+    c.chain.back().d = c.chain.back().r * (0.2f + 0.8f * u01());
+    c.compiled = compileChain(c.R, c.chain);
+
+    // short and long runs: float time precision is part of what is measured
+    c.t0 = (u01() < 0.5f) ? u01() * 10.0 : u01() * 600.0;
+    static const double kDt[] = { 1e-4, 3e-4, 1e-3, 3e-3, 1e-2 };
+    c.dt = kDt[rng() % 5];
+
+    c.nco = compileNco(c.compiled);
+    c.tick0 = ncoTicks(c.t0);
+    c.dTick = std::max<std::uint64_t>(1, ncoTicks(c.dt));
+    return c;
+}
+
+} // namespace
+
+int runConformance(int chains, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    const std::vector<Variant> vars = variants();
+
+    struct Stats {
+        double maxErr = 0.0, sumSq = 0.0, maxUlps = 0.0, maxRel = 0.0;
+        std::size_t n = 0, violations = 0;
+        int worstCase = -1;
+    };
+    std::vector<Stats> stats(vars.size());
+    std::vector<double> evalNs(vars.size(), 0.0);
+    std::vector<std::uint64_t> checksum(vars.size(), 14695981039346656037ull);   // FNV-1a
+    std::vector<sf::Vector2f> out(kSamples);
+    std::vector<std::uint8_t> hue(kSamples), refHue(kSamples);
+    std::vector<RefPoint> ref[3];   // per TimeKind
+    for (int kind = 0; kind < 3; ++kind) ref[kind].resize(kSamples);
+
+    for (int i = 0; i < chains; ++i) {
+        Case c = randomCase(rng);
+        // every motion mode in turn (not drawn from rng: the chains, and so
+        // the NCO checksums, stay those of earlier builds)
+        c.color.by = static_cast<ColorBy>(1 + i % (static_cast<int>(ColorBy::Count) - 1));
+        // the reference is evaluated at exactly the time each variant was
+        // handed, so only evaluation error is measured (float time rounding
+        // or tick quantisation is a property of the caller, not the evaluator)
+        for (int kind = 0; kind < 3; ++kind)
+            for (std::size_t k = 0; k < kSamples; ++k)
+                referencePen(c, sampleTime(c, static_cast<TimeKind>(kind), k), ref[kind][k]);
+        const CompiledChain::Term* dominant = dominantTerm(c.compiled);
+        for (std::size_t k = 0; k < kSamples; ++k) {
+            const RefPoint& r = ref[static_cast<int>(TimeKind::Double)][k];
+            refHue[k] = motionHueIndex(c.color, 0.f, sampleTime(c, TimeKind::Double, k),
+                { static_cast<float>(r.x[1]), static_cast<float>(r.y[1]) },
+                { static_cast<float>(r.x[2]), static_cast<float>(r.y[2]) }, dominant);
+        }
+
+        for (std::size_t v = 0; v < vars.size(); ++v) {
+            const auto start = std::chrono::steady_clock::now();
+            vars[v].eval(c, out, hue);
+            evalNs[v] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            Stats& st = stats[v];
+            const int kind = static_cast<int>(vars[v].time);
+            const int order = std::min(2, static_cast<int>(vars[v].what));   // RefPoint index
+            const double rel = vars[v].maxRel * derivScale(c.compiled, vars[v].what);
+            for (std::size_t k = 0; k < kSamples; ++k) {
+                const RefPoint& r = ref[kind][k];
+                double e;
+                if (vars[v].what == Quantity::Hue) {
+                    const int d = std::abs(hue[k] - refHue[k]);
+                    e = std::min(d, 256 - d);
+                }
+                else {
+                    e = std::hypot(static_cast<double>(out[k].x - r.x[order]),
+                                   static_cast<double>(out[k].y - r.y[order]));
+                }
+                const double ulps = floatUlps(c.compiled, sampleTime(c, vars[v].time, k));
+                if (!(e <= vars[v].maxErrPx + vars[v].maxUlps * ulps + rel)) ++st.violations;
+                if (e > st.maxErr || !std::isfinite(e)) { st.maxErr = std::isfinite(e) ? e : INFINITY; st.worstCase = i; }
+                st.maxUlps = std::max(st.maxUlps, e / ulps);
+                if (rel > 0.0) st.maxRel = std::max(st.maxRel, e / (rel / vars[v].maxRel));
+                st.sumSq += e * e;
+                ++st.n;
+
+                std::uint32_t bits[2];
+                std::memcpy(bits, &out[k], sizeof bits);
+                for (std::uint32_t w : bits)
+                    for (int byte = 0; byte < 4; ++byte)
+                        checksum[v] = (checksum[v] ^ ((w >> (8 * byte)) & 0xffu)) * 1099511628211ull;
+            }
+        }
+    }
+
+    int failed = 0;
+    std::cout << "conformance: " << chains << " chains x " << kSamples << " samples, seed " << seed << "\n";
+    for (std::size_t v = 0; v < vars.size(); ++v) {
+        const Stats& st = stats[v];
+        const bool ok = st.violations == 0;
+        if (!ok) ++failed;
+        const char* unit = unitName(vars[v].what);
+        std::cout << "  " << std::left << std::setw(16) << vars[v].name << std::right
+            << std::scientific << std::setprecision(3)
+            << " max " << st.maxErr << ' ' << unit << "  rms " << std::sqrt(st.sumSq / std::max<std::size_t>(1, st.n))
+            << ' ' << unit << "  ";
+        if (vars[v].what == Quantity::Hue)
+            std::cout << std::fixed << std::setprecision(0) << "bound " << vars[v].maxErrPx << ' ' << unit;
+        else if (vars[v].what == Quantity::Pen)
+            std::cout << "max " << std::fixed << std::setprecision(2) << st.maxUlps << " float-ulps"
+                << std::scientific << std::setprecision(1)
+                << "  bound " << vars[v].maxErrPx << " px + " << std::fixed << vars[v].maxUlps << " ulps";
+        else
+            std::cout << "max " << std::setprecision(2) << st.maxRel << " of scale"
+                << std::setprecision(1) << "  bound " << vars[v].maxErrPx << ' ' << unit << " + "
+                << vars[v].maxRel << " of scale" << std::fixed;
+        std::cout << (ok ? "  ok" : "  FAIL") << " (" << st.violations << " over; worst chain #" << st.worstCase << ")"
+            << std::setprecision(1) << "  " << evalNs[v] / std::max<std::size_t>(1, st.n) << " ns/sample";
+        // integer evaluators must produce the same bits everywhere: compare this across builds
+        if (vars[v].time == TimeKind::Tick)
+            std::cout << "  checksum " << std::hex << std::setw(16) << std::setfill('0') << checksum[v]
+                << std::dec << std::setfill(' ');
+        std::cout << "\n";
+    }
+    return failed ? 5 : 0;
+}
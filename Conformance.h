@@ -0,0 +1,20 @@
+// Conformance.h — cross-check every chain evaluator against a long-double reference
+//
+// --conformance N generates N random chains (stage counts, inside/outside mixes,
+// (-4)^i style speeds), evaluates a run of samples with each evaluator and
+// reports max / RMS pen error in pixels against a long-double transcription of
+// nestedPenAndCenters_perStageSpeed. The batch evaluator's analytic velocity
+// and acceleration are checked the same way, against the reference's exact
+// derivatives, relative to the largest value each can take, and the motion
+// colouring overload's hue indices (each chain in the next motion mode) must
+// be within one palette step of motionHueIndex of the reference derivatives.
+// A variant fails when its max error exceeds its bound. Each line also
+// reports ns/sample, and the integer NCO evaluators print a checksum of their
+// output bits, which must match between builds and platforms for the same
+// seed.
+#pragma once
+
+#include <cstdint>
+
+// Returns the process exit code: 0 = all variants within bounds, 5 = not.
+int runConformance(int chains, std::uint32_t seed);
@@ -0,0 +1,266 @@
+// ControlSocket.cpp — local command socket (see ControlSocket.h)
+
+#include "ControlSocket.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+using ssize_t = int;
+static int  closeHandle(SOCKET s) { return closesocket(s); }
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static bool setNonBlocking(SOCKET s) { u_long on = 1; return ioctlsocket(s, FIONBIO, &on) == 0; }
+static constexpr int kSendFlags = 0;
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+static int  closeHandle(int s) { return ::close(s); }
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+static bool setNonBlocking(int s) { return fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0; }
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = 0;
+#endif
+#endif
+
+// ---------- parsing ----------
+namespace {
+
+struct Tokens {
+    std::string_view tok[5];
+    int n = 0;
+};
+
+Tokens split(std::string_view line) {
+    Tokens t;
+    std::size_t i = 0;
+    while (i < line.size() && t.n < 5) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+        std::size_t j = i;
+        while (j < line.size() && line[j] != ' ' && line[j] != '\t') ++j;
+        if (j > i) t.tok[t.n++] = line.substr(i, j - i);
+        i = j;
+    }
+    return t;
+}
+
+bool toNumber(std::string_view s, double& out) {
+    char buf[64];
+    if (s.empty() || s.size() >= sizeof(buf)) return false;
+    std::memcpy(buf, s.data(), s.size()); buf[s.size()] = '\0';
+    char* end = nullptr;
+    out = std::strtod(buf, &end);
+    return end == buf + s.size();
+}
+
+// Returns an error message, or empty on success.
+std::string parseOp(const Tokens& t, ControlOp& op) {
+    using K = ControlOp::Kind;
+    using F = ControlOp::Field;
+    const std::string_view verb = t.tok[0];
+
+    if (verb == "set") {
+        if (t.n != 4) return "usage: set <level> <field> <value>";
+        double lvl;
+        // Range-checked before the cast below: NaN, fractions and anything
+        // outside int fail here rather than converting to garbage.
+        if (!toNumber(t.tok[1], lvl) || !(lvl >= 1 && lvl <= INT_MAX) || lvl != std::floor(lvl))
+            return "bad level";
+        const std::string_view f = t.tok[2];
+        if (f == "speed") op.field = F::Speed;
+        else if (f == "r") op.field = F::R;
+        else if (f == "d") op.field = F::D;
+        else if (f == "phase") op.field = F::Phase;
+        else if (f == "outside") op.field = F::Outside;
+        else return "unknown field '" + std::string(f) + "'";
+        if (!toNumber(t.tok[3], op.value)) return "bad value";
+        op.kind = K::SetStage;
+        op.level = static_cast<int>(lvl);
+        return {};
+    }
+    if (verb == "base") {
+        if (t.n != 2 || !toNumber(t.tok[1], op.value)) return "usage: base <R>";
+        op.kind = K::SetBase;
+        return {};
+    }
+    if (verb == "clear") { op.kind = K::Clear; return {}; }
+    if (verb == "stats") { op.kind = K::Stats; return {}; }
+    if (verb == "snapshot" || verb == "export") {
+        op.kind = (verb == "snapshot") ? K::Snapshot : K::Export;
+        if (t.n > 1) op.path = std::string(t.tok[1]);
+        return {};
+    }
+    return "unknown command '" + std::string(verb) + "'";
+}
+
+} // namespace
+
+// ---------- socket ----------
+ControlSocket::~ControlSocket() { close(); }
+
+bool ControlSocket::listen(const std::string& path) {
+    close();
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    Handle s = static_cast<Handle>(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (s == kInvalid) return false;
+#ifdef _WIN32
+    DeleteFileA(path.c_str());
+#else
+    ::unlink(path.c_str());   // stale socket from a previous run
+#endif
+    if (::bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0
+        || ::listen(s, 8) != 0 || !setNonBlocking(s)) {
+        closeHandle(s);
+        return false;
+    }
+    m_listen = s;
+    m_path = path;
+    return true;
+}
+
+void ControlSocket::close() {
+    for (auto& c : m_clients) closeHandle(c.fd);
+    m_clients.clear();
+    if (m_listen != kInvalid) {
+        closeHandle(m_listen);
+        m_listen = kInvalid;
+#ifdef _WIN32
+        DeleteFileA(m_path.c_str());
+        WSACleanup();
+#else
+        ::unlink(m_path.c_str());
+#endif
+    }
+}
+
+void ControlSocket::dropClient(std::size_t i) {
+    closeHandle(m_clients[i].fd);
+    m_clients.erase(m_clients.begin() + static_cast<std::ptrdiff_t>(i));
+}
+
+void ControlSocket::handleLine(Client& c, const char* begin, const char* end, std::vector<ControlBatch>& out) {
+    std::string_view line(begin, static_cast<std::size_t>(end - begin));
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    const Tokens t = split(line);
+    if (t.n == 0 || t.tok[0][0] == '#') return;
+
+    if (t.tok[0] == "begin") {
+        if (c.inBatch) { c.batch.error = "nested begin"; return; }
+        c.inBatch = true;
+        c.batch = ControlBatch{};
+        c.batch.client = c.id;
+        return;
+    }
+    if (t.tok[0] == "commit" || t.tok[0] == "abort") {
+        // never reply from here: reply() may drop the client we are reading
+        if (!c.inBatch) {
+            ControlBatch bad;
+            bad.client = c.id;
+            bad.error = std::string(t.tok[0]) + " without begin";
+            out.push_back(std::move(bad));
+            return;
+        }
+        c.inBatch = false;
+        if (t.tok[0] == "abort") { c.batch.ops.clear(); c.batch.error = "aborted"; }
+        out.push_back(std::move(c.batch));
+        c.batch = ControlBatch{};
+        return;
+    }
+
+    ControlOp op;
+    std::string err = parseOp(t, op);
+    if (c.inBatch) {
+        if (!err.empty()) { if (c.batch.error.empty()) c.batch.error = std::move(err); }
+        else c.batch.ops.push_back(std::move(op));
+        return;
+    }
+
+    ControlBatch single;
+    single.client = c.id;
+    if (err.empty()) single.ops.push_back(std::move(op));
+    else single.error = std::move(err);
+    out.push_back(std::move(single));
+}
+
+void ControlSocket::poll(std::vector<ControlBatch>& out, std::size_t maxBytes) {
+    if (m_listen == kInvalid) return;
+
+    for (;;) {
+        Handle c = static_cast<Handle>(::accept(m_listen, nullptr, nullptr));
+        if (c == kInvalid) break;
+        setNonBlocking(c);
+        Client cl;
+        cl.id = m_nextId++;
+        cl.fd = c;
+        m_clients.push_back(std::move(cl));
+    }
+
+    char buf[16384];
+    std::size_t budget = maxBytes;
+    for (std::size_t i = 0; i < m_clients.size() && budget > 0; ) {
+        Client& c = m_clients[i];
+        bool closed = false;
+        while (budget > 0) {
+            const std::size_t want = budget < sizeof(buf) ? budget : sizeof(buf);
+            const ssize_t n = ::recv(c.fd, buf, static_cast<int>(want), 0);
+            if (n == 0) { closed = true; break; }
+            if (n < 0) { closed = !wouldBlock(); break; }
+            budget -= static_cast<std::size_t>(n);
+
+            // complete lines straight from the receive buffer; only the
+            // trailing partial line is copied into the client's pending string
+            const char* p = buf;
+            const char* end = buf + n;
+            while (const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)))) {
+                if (!c.pending.empty()) {
+                    c.pending.append(p, nl);
+                    handleLine(c, c.pending.data(), c.pending.data() + c.pending.size(), out);
+                    c.pending.clear();
+                }
+                else {
+                    handleLine(c, p, nl, out);
+                }
+                p = nl + 1;
+            }
+            if (c.pending.size() + static_cast<std::size_t>(end - p) > kMaxLine) {
+                static const char kTooLong[] = "err line too long\n";
+                ::send(c.fd, kTooLong, static_cast<int>(sizeof kTooLong - 1), kSendFlags);
+                closed = true;
+                break;
+            }
+            c.pending.append(p, end);
+        }
+        if (closed) dropClient(i);
+        else ++i;
+    }
+}
+
+void ControlSocket::reply(std::uint64_t client, const std::string& line) {
+    for (std::size_t i = 0; i < m_clients.size(); ++i) {
+        if (m_clients[i].id != client) continue;
+        const std::string msg = line + "\n";
+        const ssize_t n = ::send(m_clients[i].fd, msg.data(), static_cast<int>(msg.size()), kSendFlags);
+        if (n != static_cast<ssize_t>(msg.size())) dropClient(i);
+        return;
+    }
+}
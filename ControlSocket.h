@@ -0,0 +1,78 @@
+// ControlSocket.h — local (Unix-domain) command socket for scripted control
+//
+// Line protocol, one command per line:
+//   set <level> <speed|r|d|phase|outside> <value>
+//   base <R>
+//   clear | snapshot [file.png] | export [file.txt] | stats
+//   begin ... commit     group lines into one batch (abort drops it)
+// Lines outside begin/commit are a batch of one. A batch is validated in full
+// before anything is applied, so a bad line rejects the whole batch and the
+// chain is never left half-updated. Each batch gets one reply line.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ControlOp {
+    enum class Kind { SetStage, SetBase, Clear, Snapshot, Export, Stats };
+    enum class Field { Speed, R, D, Phase, Outside };
+
+    Kind        kind = Kind::Stats;
+    int         level = 0;        // SetStage: 1-based, as shown in the HUD
+    Field       field = Field::Speed;
+    double      value = 0.0;
+    std::string path;             // Snapshot / Export (empty = default name)
+};
+
+struct ControlBatch {
+    std::uint64_t          client = 0;   // reply handle
+    std::vector<ControlOp> ops;
+    std::string            error;        // non-empty: parse failed, apply nothing
+};
+
+class ControlSocket {
+public:
+    ControlSocket() = default;
+    ~ControlSocket();
+    ControlSocket(const ControlSocket&) = delete;
+    ControlSocket& operator=(const ControlSocket&) = delete;
+
+    bool listen(const std::string& path);
+    void close();
+    bool isOpen() const { return m_listen != kInvalid; }
+
+    // Non-blocking: accepts clients, drains readable bytes (at most maxBytes in
+    // total so a flood cannot stall the frame) and appends finished batches.
+    void poll(std::vector<ControlBatch>& out, std::size_t maxBytes = 1 << 20);
+
+    // Best-effort reply; a client that is gone or not reading is dropped.
+    void reply(std::uint64_t client, const std::string& line);
+
+private:
+#ifdef _WIN32
+    using Handle = std::uintptr_t;
+#else
+    using Handle = int;
+#endif
+    static constexpr Handle kInvalid = static_cast<Handle>(-1);
+    // A client whose line grows past this without a '\n' is disconnected.
+    static constexpr std::size_t kMaxLine = 4096;
+
+    struct Client {
+        std::uint64_t id = 0;
+        Handle        fd = kInvalid;
+        std::string   pending;     // partial line
+        bool          inBatch = false;
+        ControlBatch  batch;
+    };
+
+    void handleLine(Client& c, const char* begin, const char* end, std::vector<ControlBatch>& out);
+    void dropClient(std::size_t i);
+
+    Handle              m_listen = kInvalid;
+    std::string         m_path;
+    std::vector<Client> m_clients;
+    std::uint64_t       m_nextId = 1;
+};
@@ -0,0 +1,14 @@
+// EmbeddedFont.cpp — font bytes (see EmbeddedFont.h)
+
+#include "EmbeddedFont.h"
+
+namespace {
+
+const unsigned char kFont[] = {
+#include "EmbeddedFont.inc"
+};
+
+} // namespace
+
+const unsigned char* embeddedFontData() { return kFont; }
+std::size_t embeddedFontSize() { return sizeof kFont; }
@@ -0,0 +1,10 @@
+// EmbeddedFont.h — the HUD/help font, compiled into the binary
+//
+// Startup no longer depends on the working directory or on the case of
+// Assets/Fonts/. Regenerate EmbeddedFont.inc with tools/embed_font.py.
+#pragma once
+
+#include <cstddef>
+
+const unsigned char* embeddedFontData();
+std::size_t embeddedFontSize();
@@ -0,0 +1,254 @@
+// ExportJobs.cpp — PNG save and curve render jobs (see ExportJobs.h)
+
+#include "ExportJobs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+
+#include "Spirograph.h"
+
+namespace {
+
+constexpr std::size_t kFramesPerSlice = 16;   // between deadline checks
+constexpr int kFramesAheadPerThread = 2;      // animation reorder window
+
+} // namespace
+
+// ---------- SaveImageJob ----------
+bool SaveImageJob::step(Clock::time_point) {
+    if (!saved_.valid()) {
+        if (cancelled_) return true;
+        saved_ = std::async(std::launch::async, [this] { return image_.saveToFile(path_); });
+    }
+    if (saved_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+
+    const bool ok = saved_.get();
+    if (cancelled_ && ok) std::remove(path_.c_str());
+    result_ = ok ? "saved " + path_ : "could not save " + path_;
+    return true;
+}
+
+// ---------- CurveRenderJob ----------
+CurveRenderJob::CurveRenderJob(std::string what, std::vector<CurveImage> images,
+    sf::Vector2u size, float scale, const TraceStyle& style)
+    : what_(std::move(what)), images_(std::move(images)), size_(size), scale_(scale), style_(style)
+{
+    style_.maxPixelStep /= scale_;
+    beginImage();
+}
+
+void CurveRenderJob::beginImage() {
+    run_ = frame_ = 0;
+    doneT_ = totalT_ = 0.0;
+    if (image_ >= images_.size()) return;
+    for (const TraceRun& r : images_[image_].runs) totalT_ += std::max(0.0, r.t1 - r.t0);
+    // the canvas is allocated tile by tile as it is drawn on, so a fresh one is cheap
+    canvas_.resize(size_, style_.center, scale_);
+}
+
+bool CurveRenderJob::step(Clock::time_point deadline) {
+    while (Clock::now() < deadline) {
+        if (save_) {
+            if (cancelled_) save_->cancel();
+            if (!save_->step(deadline)) return false;   // still encoding: come back next frame
+            if (save_->cancelled()) return true;
+            if (save_->result().rfind("saved", 0) != 0) ++failed_;
+            save_.reset();
+            ++image_;
+            beginImage();
+        }
+        if (cancelled_) return true;
+        if (image_ >= images_.size()) {
+            const int n = static_cast<int>(images_.size());
+            result_ = what_ + ": " + std::to_string(n - failed_) + " of " + std::to_string(n) + " PNGs written";
+            if (n == 1 && failed_ == 0) result_ = what_ + ": saved " + images_[0].path;
+            return true;
+        }
+
+        const CurveImage& img = images_[image_];
+        if (run_ >= img.runs.size()) {
+            save_ = std::make_unique<SaveImageJob>(canvas_.toImage(), img.path);
+            continue;
+        }
+
+        // a slice of replayed frames of the current run
+        const TraceRun& run = img.runs[run_];
+        if (frame_ == 0) pathLen_ = run.pathLen0;
+        for (std::size_t k = 0; k < kFramesPerSlice; ++k, ++frame_) {
+            const double ta = run.t0 + style_.frameDt * frame_;
+            if (ta >= run.t1) { ++run_; frame_ = 0; break; }
+            const double tb = std::min(run.t1, ta + style_.frameDt);
+            traceFrame(run.chain, ta, tb, style_, scratch_, [&](sf::Vector2f p, sf::Vector2f q, const std::uint8_t* hue,
+                const float* w, const sf::Vector2f*) {
+                const double len0 = pathLen_;
+                pathLen_ += std::hypot(q.x - p.x, q.y - p.y);
+                canvas_.drawSegment(p, q, w ? 0.5f * (w[0] + w[1]) : style_.stroke,   // the mean, like the live indexed canvas
+                    hue ? hue[0] : pathHueIndex(len0, style_.pixelsPerCycle, style_.hueOffset),
+                    hue ? hue[1] : pathHueIndex(pathLen_, style_.pixelsPerCycle, style_.hueOffset));
+                });
+            doneT_ += tb - ta;
+        }
+    }
+    return false;
+}
+
+float CurveRenderJob::progress() const {
+    if (images_.empty()) return 1.f;
+    const double part = save_ ? 1.0 : (totalT_ > 0.0 ? doneT_ / totalT_ : 0.0);
+    return static_cast<float>((image_ + std::min(1.0, part)) / images_.size());
+}
+
+std::string CurveRenderJob::label() const {
+    if (images_.size() <= 1) return what_;
+    return what_ + " " + std::to_string(std::min(image_ + 1, images_.size())) + "/" + std::to_string(images_.size());
+}
+
+// ---------- AnimationJob ----------
+AnimationJob::AnimationJob(std::string prefix, float R, std::vector<Stage> chain, Timeline timeline,
+    sf::Vector2u size, float scale, const TraceStyle& style, double maxCurveSeconds, unsigned threads)
+    : prefix_(std::move(prefix)), R_(R), chain_(std::move(chain)), timeline_(std::move(timeline)),
+      size_(size), scale_(scale), style_(style), maxCurveSeconds_(maxCurveSeconds)
+{
+    style_.maxPixelStep /= scale_;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads_ = std::min(threads, static_cast<unsigned>(std::max(1, timeline_.frames)));
+    window_ = kFramesAheadPerThread * static_cast<int>(threads_);
+}
+
+AnimationJob::~AnimationJob() {
+    cancelled_ = true;
+    stop();
+}
+
+void AnimationJob::stop() {
+    // cancel() sets the flag without the lock: taking it here orders the flag
+    // before the notify, so no worker can check, miss it and then sleep
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+    for (std::thread& w : workers_) w.join();
+    workers_.clear();
+}
+
+std::string AnimationJob::framePath(int frame) const {
+    std::ostringstream name;
+    name << prefix_ << std::setw(5) << std::setfill('0') << frame << ".png";
+    return name.str();
+}
+
+bool AnimationJob::renderFrame(int frame, IndexedCanvas& canvas, TraceScratch& scratch,
+    std::vector<std::uint8_t>& png) const
+{
+    float R = R_;
+    std::vector<Stage> chain = chain_;
+    timeline_.apply(timeline_.frameU(frame), R, chain);
+    const CompiledChain compiled = compileChain(R, chain);
+    const double t1 = timeline_.seconds > 0.0 ? timeline_.seconds : curvePeriod(compiled, maxCurveSeconds_);
+
+    canvas.clear(true);
+    double pathLen = 0.0;
+    std::size_t k = 0;
+    for (double ta = 0.0; ta < t1; ta = style_.frameDt * ++k) {
+        if (k % kFramesPerSlice == 0 && cancelled_) return false;
+        const double tb = std::min(t1, ta + style_.frameDt);
+        traceFrame(compiled, ta, tb, style_, scratch, [&](sf::Vector2f p, sf::Vector2f q, const std::uint8_t* hue,
+            const float* w, const sf::Vector2f*) {
+            const double len0 = pathLen;
+            pathLen += std::hypot(q.x - p.x, q.y - p.y);
+            canvas.drawSegment(p, q, w ? 0.5f * (w[0] + w[1]) : style_.stroke,
+                hue ? hue[0] : pathHueIndex(len0, style_.pixelsPerCycle, style_.hueOffset),
+                hue ? hue[1] : pathHueIndex(pathLen, style_.pixelsPerCycle, style_.hueOffset));
+            });
+    }
+    std::optional<std::vector<std::uint8_t>> encoded = canvas.toImage().saveToMemory("png");
+    if (encoded) png = std::move(*encoded);
+    else png.clear();   // counted as failed when its turn comes
+    return true;
+}
+
+void AnimationJob::work() {
+    TraceScratch scratch;
+    for (;;) {
+        std::unique_ptr<IndexedCanvas> canvas;
+        int frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] {
+                return cancelled_ || next_ >= timeline_.frames || next_ < written_ + window_;
+                });
+            if (cancelled_ || next_ >= timeline_.frames) return;
+            frame = next_++;
+            if (!pool_.empty()) { canvas = std::move(pool_.back()); pool_.pop_back(); }
+        }
+        if (!canvas) {
+            // tiles are allocated as they are drawn on and kept by clear(true)
+            canvas = std::make_unique<IndexedCanvas>();
+            canvas->resize(size_, style_.center, scale_);
+        }
+
+        std::vector<std::uint8_t> png;
+        const bool done = renderFrame(frame, *canvas, scratch, png);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        pool_.push_back(std::move(canvas));
+        if (!done) return;
+        ready_.emplace(frame, std::move(png));
+        cv_.notify_all();
+    }
+}
+
+bool AnimationJob::step(Clock::time_point deadline) {
+    if (workers_.empty() && !cancelled_ && written_ < timeline_.frames) {
+        started_ = Clock::now();
+        for (unsigned i = 0; i < threads_; ++i) workers_.emplace_back([this] { work(); });
+    }
+
+    // write whatever is next in order; frames after a gap wait in ready_
+    while (!cancelled_ && written_ < timeline_.frames && Clock::now() < deadline) {
+        std::vector<std::uint8_t> png;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = ready_.find(written_);
+            if (it == ready_.end()) break;
+            png = std::move(it->second);
+            ready_.erase(it);
+        }
+        std::ofstream out(framePath(written_), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+        if (png.empty() || !out) ++failed_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++written_;
+        }
+        cv_.notify_all();
+    }
+
+    if (cancelled_) {
+        stop();
+        result_ = "Animation cancelled after " + std::to_string(written_.load()) + " frames";
+        return true;
+    }
+    if (written_ < timeline_.frames) return false;
+
+    stop();
+    const double secs = std::chrono::duration<double>(Clock::now() - started_).count();
+    std::ostringstream r;
+    r << "Animation: " << timeline_.frames - failed_ << " of " << timeline_.frames << " frames to "
+      << framePath(0) << ".. in " << std::fixed << std::setprecision(1) << secs << " s ("
+      << timeline_.frames / std::max(1e-9, secs) << " frames/s, " << threads_ << " threads)";
+    result_ = r.str();
+    return true;
+}
+
+float AnimationJob::progress() const {
+    return timeline_.frames > 0 ? static_cast<float>(written_) / timeline_.frames : 1.f;
+}
+
+std::string AnimationJob::label() const {
+    return "Animation " + std::to_string(std::min(written_.load() + 1, timeline_.frames)) + "/"
+        + std::to_string(timeline_.frames) + " (" + std::to_string(threads_) + " threads)";
+}
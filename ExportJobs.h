@@ -0,0 +1,122 @@
+// ExportJobs.h — jobs that write PNGs without stalling the frame (see Jobs.h)
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Animation.h"
+#include "IndexedCanvas.h"
+#include "Jobs.h"
+#include "TraceRebuild.h"
+
+// Encodes an image captured on the main thread to a PNG on a worker thread.
+// The encoder cannot be interrupted; a cancelled save deletes the file once
+// it is written.
+class SaveImageJob : public Job {
+public:
+    SaveImageJob(sf::Image image, std::string path) : image_(std::move(image)), path_(std::move(path)) {}
+
+    bool step(Clock::time_point deadline) override;
+    float progress() const override { return saved_.valid() ? 0.5f : 0.f; }
+    std::string label() const override { return "Saving " + path_; }
+
+private:
+    sf::Image image_;
+    std::string path_;
+    std::future<bool> saved_;   // its destructor waits for the encoder
+};
+
+// One picture: the runs are traced in order onto a fresh canvas, each from its
+// own rainbow position, the way the live trace would have drawn them.
+struct CurveImage {
+    std::vector<TraceRun> runs;
+    std::string path;
+};
+
+// Traces a list of pictures on a CPU canvas (size pixels, `scale` pixels per
+// logical unit) and saves each as a PNG. Tracing happens in slices of
+// replayed frames inside step(); encoding goes to a SaveImageJob.
+class CurveRenderJob : public Job {
+public:
+    CurveRenderJob(std::string what, std::vector<CurveImage> images,
+        sf::Vector2u size, float scale, const TraceStyle& style);
+
+    bool step(Clock::time_point deadline) override;
+    float progress() const override;
+    std::string label() const override;
+
+private:
+    void beginImage();
+
+    std::string what_;
+    std::vector<CurveImage> images_;
+    sf::Vector2u size_;
+    float scale_;
+    TraceStyle style_;   // logical units (the caller passes maxPixelStep in canvas pixels)
+
+    IndexedCanvas canvas_;
+    TraceScratch scratch_;
+    std::unique_ptr<SaveImageJob> save_;
+
+    // resume point
+    std::size_t image_ = 0, run_ = 0, frame_ = 0;
+    double pathLen_ = 0.0;
+    double doneT_ = 0.0, totalT_ = 0.0;   // traced / total time of the current image
+    int failed_ = 0;
+};
+
+// Renders a timeline's frames (see Animation.h) to <prefix>00000.png, ...
+// Worker threads each take the next frame number, trace the whole figure on
+// a canvas from a shared pool and encode the PNG; finished frames wait in a
+// reorder buffer until step() has written every frame before them, so files
+// appear in frame order. Workers stay at most a window of frames ahead of
+// the writer, which bounds the buffer.
+class AnimationJob : public Job {
+public:
+    AnimationJob(std::string prefix, float R, std::vector<Stage> chain, Timeline timeline,
+        sf::Vector2u size, float scale, const TraceStyle& style, double maxCurveSeconds, unsigned threads = 0);
+    ~AnimationJob() override;
+
+    bool step(Clock::time_point deadline) override;
+    float progress() const override;
+    std::string label() const override;
+
+    unsigned threads() const { return threads_; }
+    int failed() const { return failed_; }   // frames not encoded or not written
+
+private:
+    void work();
+    // false when cancelled part way
+    bool renderFrame(int frame, IndexedCanvas& canvas, TraceScratch& scratch, std::vector<std::uint8_t>& png) const;
+    std::string framePath(int frame) const;
+    void stop();
+
+    std::string prefix_;
+    float R_;
+    std::vector<Stage> chain_;
+    Timeline timeline_;
+    sf::Vector2u size_;
+    float scale_;
+    TraceStyle style_;   // logical units, like CurveRenderJob's
+    double maxCurveSeconds_;
+    unsigned threads_;
+    int window_;         // frames handed out beyond the next one to write
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<IndexedCanvas>> pool_;        // idle canvases
+    std::map<int, std::vector<std::uint8_t>> ready_;          // reorder buffer: encoded, not yet written
+    int next_ = 0;       // next frame to hand out
+    std::atomic<int> written_{ 0 };
+    int failed_ = 0;
+    Clock::time_point started_;
+};
@@ -0,0 +1,132 @@
+// FlightRecorder.cpp — per-frame ring + slow-frame reports (see FlightRecorder.h)
+
+#include "FlightRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+void FlightRecorder::configure(std::size_t frames, double slowMs, std::string dir) {
+    ring_.assign(std::max<std::size_t>(frames, 1), Frame{});
+    next_ = count_ = 0;
+    slowMs_ = slowMs;
+    dir_ = dir.empty() ? "." : std::move(dir);
+    cooldownUntil_ = 0;
+    pendingSlow_ = -1;
+    origin_ = Clock::now();
+}
+
+const char* FlightRecorder::phaseName(Phase p) {
+    switch (p) {
+    case Phase::Events:  return "events";
+    case Phase::Control: return "control";
+    case Phase::Update:  return "update";
+    case Phase::Trace:   return "trace";
+    case Phase::Rebuild: return "rebuild";
+    case Phase::Jobs:    return "jobs";
+    case Phase::Draw:    return "draw";
+    case Phase::Present: return "present";
+    default:             return "?";
+    }
+}
+
+void FlightRecorder::beginFrame(long index) {
+    cur_ = Frame{};
+    cur_.index = index;
+    if (afterDump_) { cur_.flags |= AfterDump; afterDump_ = false; }
+    frameStart_ = phaseStart_ = Clock::now();
+    cur_.startS = std::chrono::duration<double>(frameStart_ - origin_).count();
+    curPhase_ = Phase::Events;
+}
+
+void FlightRecorder::phase(Phase p) {
+    const Clock::time_point now = Clock::now();
+    cur_.phaseMs[static_cast<std::size_t>(curPhase_)] +=
+        std::chrono::duration<float, std::milli>(now - phaseStart_).count();
+    phaseStart_ = now;
+    curPhase_ = p;
+}
+
+void FlightRecorder::setAllocs(std::uint64_t allocs, std::uint64_t bytes) {
+    cur_.allocs = static_cast<std::int64_t>(allocs);
+    cur_.allocBytes = static_cast<std::int64_t>(bytes);
+}
+
+std::string FlightRecorder::endFrame() {
+    phase(curPhase_);   // close the running phase
+    cur_.totalMs = std::chrono::duration<float, std::milli>(phaseStart_ - frameStart_).count();
+    if (ring_.empty()) return {};
+
+    ring_[next_] = cur_;
+    next_ = (next_ + 1) % ring_.size();
+    count_ = std::min(count_ + 1, ring_.size());
+
+    // A slow frame inside the cooldown is not lost: the report is written once
+    // the cooldown ends, while the frame is still in the ring.
+    if (slowMs_ > 0.0 && cur_.totalMs > slowMs_ && pendingSlow_ < 0) pendingSlow_ = cur_.index;
+    if (pendingSlow_ < 0 || cur_.index < cooldownUntil_) return {};
+
+    char name[32];
+    std::snprintf(name, sizeof name, "flight_%06ld.txt", pendingSlow_);
+    const std::string path = dir_ + "/" + name;
+    pendingSlow_ = -1;
+    cooldownUntil_ = cur_.index + static_cast<long>(ring_.size());
+    afterDump_ = true;
+    if (!writeReport(path)) return {};
+    ++reports_;
+    return path;
+}
+
+bool FlightRecorder::writeReport(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    const std::size_t first = (next_ + ring_.size() - count_) % ring_.size();
+    auto at = [&](std::size_t i) -> const Frame& { return ring_[(first + i) % ring_.size()]; };
+
+    float maxMs = 0.f, sumMs = 0.f, phaseMax[kPhases] = {}, phaseSum[kPhases] = {};
+    for (std::size_t i = 0; i < count_; ++i) {
+        const Frame& f = at(i);
+        maxMs = std::max(maxMs, f.totalMs);
+        sumMs += f.totalMs;
+        for (std::size_t p = 0; p < kPhases; ++p) {
+            phaseMax[p] = std::max(phaseMax[p], f.phaseMs[p]);
+            phaseSum[p] += f.phaseMs[p];
+        }
+    }
+
+    const std::time_t now = std::time(nullptr);
+    out << "flight recorder report, " << std::ctime(&now)
+        << "frames " << at(0).index << ".." << at(count_ - 1).index
+        << ", threshold " << slowMs_ << " ms ('>' marks frames over it)\n"
+        << "flags: S snapshot, X export, R resize, E edit, W rebuild swap, C substep cap, D after report\n\n"
+        << std::fixed << std::setprecision(2)
+        << "phase        avg ms    max ms\n";
+    for (std::size_t p = 0; p < kPhases; ++p)
+        out << std::left << std::setw(10) << phaseName(static_cast<Phase>(p)) << std::right
+            << std::setw(9) << phaseSum[p] / count_ << std::setw(10) << phaseMax[p] << "\n";
+    out << std::left << std::setw(10) << "frame" << std::right
+        << std::setw(9) << sumMs / count_ << std::setw(10) << maxMs << "\n\n";
+
+    out << "  frame       t_s  total_ms";
+    for (std::size_t p = 0; p < kPhases; ++p) out << std::setw(9) << phaseName(static_cast<Phase>(p));
+    out << "  samples  draws   allocs   alloc_kb  flags\n";
+
+    const char kFlagChars[] = "SXREWCD";
+    for (std::size_t i = 0; i < count_; ++i) {
+        const Frame& f = at(i);
+        out << (slowMs_ > 0.0 && f.totalMs > slowMs_ ? '>' : ' ')
+            << std::setw(6) << f.index << std::setprecision(3) << std::setw(10) << f.startS
+            << std::setprecision(2) << std::setw(10) << f.totalMs;
+        for (std::size_t p = 0; p < kPhases; ++p) out << std::setw(9) << f.phaseMs[p];
+        out << std::setw(9) << f.samples << std::setw(7) << f.drawCalls;
+        if (f.allocs >= 0) out << std::setw(9) << f.allocs << std::setprecision(1) << std::setw(11) << f.allocBytes / 1024.0;
+        else out << std::setw(9) << '-' << std::setw(11) << '-';
+        out << "  ";
+        for (int b = 0; kFlagChars[b]; ++b) out << ((f.flags >> b) & 1u ? kFlagChars[b] : '.');
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
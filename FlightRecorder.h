@@ -0,0 +1,81 @@
+// FlightRecorder.h — always-on record of the last few hundred frames
+//
+// Every frame gets a fixed-size record: time spent per main-loop phase, trace
+// samples, draw calls, heap allocations (when alloc tracking is on) and flags
+// for the things that tend to cause hitches (snapshot, resize, ...). Records
+// live in a ring allocated once up front, so recording costs a few clock
+// reads per frame and never allocates. When a frame takes longer than the
+// threshold, the whole ring is written to <dir>/flight_<frame>.txt. At most
+// one report is written per ring's worth of frames, so a burst of slow frames
+// ends up in one file rather than many near-identical ones.
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class FlightRecorder {
+public:
+    enum class Phase : std::uint8_t { Events, Control, Update, Trace, Rebuild, Jobs, Draw, Present, Count };
+    static constexpr std::size_t kPhases = static_cast<std::size_t>(Phase::Count);
+
+    enum Flag : std::uint32_t {
+        Snapshot = 1u << 0,   // PNG written
+        Export = 1u << 1,     // chain text written
+        Resize = 1u << 2,
+        Edit = 1u << 3,       // chain changed (keys or control socket)
+        RebuildSwap = 1u << 4, // re-rendered canvas adopted
+        SubstepCap = 1u << 5, // trace hit maxSubsteps
+        AfterDump = 1u << 6,  // previous frame wrote a report (its time is not in here)
+    };
+
+    struct Frame {
+        long          index = -1;
+        double        startS = 0.0;           // since the recorder was configured
+        float         totalMs = 0.f;
+        float         phaseMs[kPhases] = {};
+        std::uint32_t samples = 0;
+        std::uint32_t drawCalls = 0;
+        std::int64_t  allocs = -1;            // -1 = alloc tracking off
+        std::int64_t  allocBytes = -1;
+        std::uint32_t flags = 0;
+    };
+
+    // slowMs <= 0 keeps recording but never writes reports.
+    void configure(std::size_t frames, double slowMs, std::string dir);
+
+    void beginFrame(long index);
+    void phase(Phase p);                 // time from here on counts to p
+    void addSamples(std::uint32_t n) { cur_.samples += n; }
+    void addDrawCalls(std::uint32_t n) { cur_.drawCalls += n; }
+    void flag(Flag f) { cur_.flags |= f; }
+    void setAllocs(std::uint64_t allocs, std::uint64_t bytes);
+
+    // Closes the frame. Returns the report path if this frame triggered one.
+    std::string endFrame();
+
+    static const char* phaseName(Phase p);
+
+    double slowMs() const { return slowMs_; }
+    int reports() const { return reports_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool writeReport(const std::string& path) const;
+
+    std::vector<Frame> ring_;
+    std::size_t next_ = 0, count_ = 0;
+    double slowMs_ = 50.0;
+    std::string dir_ = ".";
+    long cooldownUntil_ = 0;   // frame index before which no new report is written
+    long pendingSlow_ = -1;    // slow frame still waiting for its report
+    int reports_ = 0;
+
+    Frame cur_;
+    Phase curPhase_ = Phase::Events;
+    Clock::time_point origin_ = Clock::now(), frameStart_, phaseStart_;
+    bool afterDump_ = false;
+};
@@ -0,0 +1,218 @@
+// Golden.cpp — headless golden-image regression run (see Golden.h)
+
+#include "Golden.h"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Spirograph.h"
+#include "Tracer.h"
+
+namespace {
+
+constexpr double   kDt = 1.0 / 120.0;       // fixed step: one "frame"
+constexpr float    kBadDelta = 20.f;        // per-pixel difference that counts (0..255)
+constexpr double   kMaxBadFraction = 0.002; // share of bad pixels a match may have
+constexpr double   kSlowFactor = 2.0;       // flag renders this much slower than reference
+constexpr int      kTimedRuns = 5;          // after one untimed warm-up; the median counts
+
+struct Scene {
+    const char* name;
+    float R;
+    int frames;
+    std::function<std::vector<Stage>(float R)> build;
+};
+
+std::vector<Scene> scenes() {
+    return {
+        { "default10", 200.f, 480, [](float R) { return defaultChain(R); } },
+        { "hypotrochoid", 200.f, 960, [](float) {
+            std::vector<Stage> c;
+            c.emplace_back(1, 75.f, 60.f, false, 1.3f);
+            return c; } },
+        { "epitrochoid", 150.f, 960, [](float) {
+            std::vector<Stage> c;
+            c.emplace_back(1, 50.f, 70.f, true, 1.5f);
+            return c; } },
+        { "mixed5", 220.f, 720, [](float R) {
+            std::vector<Stage> c;
+            const float speeds[] = { 1.f, -2.5f, 4.f, -7.f, 11.f };
+            float r = R;
+            for (int i = 0; i < 5; ++i) {
+                r *= 0.48f;
+                c.emplace_back(i + 1, r, 0.f, (i % 2) == 1, speeds[i]);
+            }
+            c.back().d = c.back().r * 0.9f;
+            return c; } },
+    };
+}
+
+struct Rendered {
+    sf::Image image;
+    double    ms = 0.0;
+    long      segments = 0;
+};
+
+Rendered renderOnce(const Scene& sc) {
+    // no MSAA: sample patterns differ between GPUs/drivers
+    sf::RenderTexture rt({ kLogicalW, kLogicalH });
+    rt.clear(sf::Color::Transparent);
+
+    const std::vector<Stage> chain = sc.build(sc.R);
+    const sf::Vector2f center{ kLogicalW * 0.5f, kLogicalH * 0.5f };
+    Tracer tracer;
+    Rendered out;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f <= sc.frames; ++f) {
+        const double t = f * kDt;
+        out.segments += tracer.advance(rt, sc.R, chain, center, t, 1.f,
+            [](double, sf::Vector2f, sf::Vector2f, sf::Color, sf::Color) {});
+    }
+    rt.display();
+    out.image = rt.getTexture().copyToImage();   // also waits for the GPU
+    out.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return out;
+}
+
+// Warm-up, then the median of kTimedRuns; the image is the last run's (every
+// run draws the same frames).
+Rendered renderScene(const Scene& sc) {
+    renderOnce(sc);
+    std::vector<double> ms;
+    Rendered out;
+    for (int i = 0; i < kTimedRuns; ++i) {
+        out = renderOnce(sc);
+        ms.push_back(out.ms);
+    }
+    std::nth_element(ms.begin(), ms.begin() + ms.size() / 2, ms.end());
+    out.ms = ms[ms.size() / 2];
+    return out;
+}
+
+// Composites over the app background and box-blurs 3x3, so single-pixel
+// rasterisation shifts between drivers do not count as differences.
+std::vector<float> perceptual(const sf::Image& img) {
+    const sf::Vector2u sz = img.getSize();
+    const std::uint8_t* px = img.getPixelsPtr();
+    const float bg[3] = { 15.f, 18.f, 22.f };
+
+    std::vector<float> rgb(std::size_t(sz.x) * sz.y * 3);
+    for (std::size_t i = 0; i < std::size_t(sz.x) * sz.y; ++i) {
+        const float a = px[i * 4 + 3] / 255.f;
+        for (int c = 0; c < 3; ++c) rgb[i * 3 + c] = px[i * 4 + c] * a + bg[c] * (1.f - a);
+    }
+
+    std::vector<float> out(rgb.size());
+    for (unsigned y = 0; y < sz.y; ++y) {
+        for (unsigned x = 0; x < sz.x; ++x) {
+            float acc[3] = { 0.f, 0.f, 0.f };
+            int n = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int xx = static_cast<int>(x) + dx, yy = static_cast<int>(y) + dy;
+                    if (xx < 0 || yy < 0 || xx >= static_cast<int>(sz.x) || yy >= static_cast<int>(sz.y)) continue;
+                    const std::size_t j = (std::size_t(yy) * sz.x + xx) * 3;
+                    acc[0] += rgb[j]; acc[1] += rgb[j + 1]; acc[2] += rgb[j + 2]; ++n;
+                }
+            }
+            const std::size_t i = (std::size_t(y) * sz.x + x) * 3;
+            for (int c = 0; c < 3; ++c) out[i + c] = acc[c] / n;
+        }
+    }
+    return out;
+}
+
+// Share of pixels whose luma-weighted colour distance exceeds kBadDelta.
+double badFraction(const sf::Image& a, const sf::Image& b) {
+    if (a.getSize() != b.getSize()) return 1.0;
+    const std::vector<float> pa = perceptual(a), pb = perceptual(b);
+    std::size_t bad = 0;
+    for (std::size_t i = 0; i < pa.size(); i += 3) {
+        const float dr = pa[i] - pb[i], dg = pa[i + 1] - pb[i + 1], db = pa[i + 2] - pb[i + 2];
+        if (std::sqrt(0.299f * dr * dr + 0.587f * dg * dg + 0.114f * db * db) > kBadDelta) ++bad;
+    }
+    return static_cast<double>(bad) / (pa.size() / 3);
+}
+
+double readReferenceMs(const std::string& path) {
+    std::ifstream in(path);
+    double ms = 0.0;
+    return (in >> ms) ? ms : 0.0;
+}
+
+} // namespace
+
+int runGolden(const std::string& dir, bool update, bool perfGate) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);   // first --golden-update into a new DIR
+    std::ofstream csv(dir + "/timings.csv", std::ios::app);
+    if (ec || !csv) {
+        std::cerr << "cannot write to " << dir << (ec ? ": " + ec.message() : std::string()) << "\n";
+        return 4;
+    }
+    if (csv.tellp() == 0) csv << "time,scene,frames,segments,ms,ms_per_frame,bad_fraction,result\n";
+    const std::time_t now = std::time(nullptr);
+
+    int failures = 0, missing = 0;
+    for (const Scene& sc : scenes()) {
+        const Rendered r = renderScene(sc);
+        const std::string png = dir + "/" + sc.name + ".png";
+        const std::string ref = dir + "/" + sc.name + ".ms";
+        std::string result;
+        double bad = 0.0;
+
+        if (update) {
+            std::ofstream refOut(ref);
+            refOut << r.ms << "\n";
+            refOut.close();
+            result = (refOut && r.image.saveToFile(png)) ? "updated" : "write-failed";
+            if (result != "updated") ++failures;
+        }
+        else {
+            sf::Image golden;
+            if (!golden.loadFromFile(png)) {
+                result = "missing";
+                ++failures;
+                ++missing;
+            }
+            else {
+                bad = badFraction(r.image, golden);
+                result = bad <= kMaxBadFraction ? "pass" : "FAIL";
+                if (result == "FAIL") {
+                    ++failures;
+                    r.image.saveToFile(dir + "/" + sc.name + ".actual.png");
+                }
+            }
+            const double refMs = readReferenceMs(ref);
+            if (refMs > 0.0 && r.ms > refMs * kSlowFactor) {
+                if (perfGate && result == "pass") ++failures;   // opted in: a slowdown alone fails
+                result += "+SLOW";
+            }
+        }
+
+        std::cout << std::left << std::setw(14) << sc.name << std::right
+            << std::setw(8) << r.segments << " segs "
+            << std::fixed << std::setprecision(1) << std::setw(9) << r.ms << " ms  "
+            << std::setprecision(4) << "bad " << bad * 100.0 << "%  " << result << "\n";
+        csv << now << ',' << sc.name << ',' << sc.frames << ',' << r.segments << ','
+            << r.ms << ',' << r.ms / sc.frames << ',' << bad << ',' << result << '\n';
+        if (!csv) {
+            std::cerr << "cannot write " << dir << "/timings.csv\n";
+            return 4;
+        }
+    }
+    if (missing > 0)
+        std::cout << missing << " golden image(s) missing in " << dir
+            << ": run once with --golden-update to make references on this machine\n";
+    return failures ? 4 : 0;
+}
@@ -0,0 +1,26 @@
+// Golden.h — headless golden-image regression run (--golden DIR)
+//
+// Renders a fixed set of canonical scenes off-screen with a fixed time step,
+// compares each against DIR/<scene>.png with a perceptual tolerance, and
+// appends the render time per scene to DIR/timings.csv. With update set the
+// goldens (and reference timings) are rewritten instead.
+//
+// A scene is rendered once untimed (driver and shader setup, first-use
+// caches) and its time is the median of the timed runs after that. One
+// slower than kSlowFactor times DIR/<scene>.ms is flagged SLOW. Timings move
+// with the machine and its load, so SLOW is only a report unless perfGate
+// (--golden-perf) asks for it to fail the run.
+//
+// No goldens ship with the source: rendering depends on the GPU and driver,
+// so references are made on the machine that will check them. Bootstrap a
+// checkout (or a CI runner's cache) once with
+//     --golden DIR --golden-update
+// and every later --golden DIR run compares against that. Until then every
+// scene reports "missing".
+#pragma once
+
+#include <string>
+
+// Returns the process exit code: 0 = all scenes match, 4 = mismatch, missing,
+// a golden or timing not written, or (with perfGate) SLOW.
+int runGolden(const std::string& dir, bool update, bool perfGate);
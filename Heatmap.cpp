@@ -0,0 +1,139 @@
+// Heatmap.cpp — sample-density and overdraw debug view (see Heatmap.h)
+
+#include "Heatmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kLog2Range = 12.f;   // 4096 and more: the top of the ramp
+
+// Dark blue -> magenta -> orange -> yellow -> white; alpha rises with the count.
+std::array<std::uint8_t, 4> rampAt(float u) {
+    static const float stops[][4] = {
+        { 20, 30, 140, 110 }, { 170, 40, 160, 170 }, { 250, 130, 30, 210 }, { 255, 230, 60, 235 }, { 255, 255, 255, 250 },
+    };
+    const float f = std::clamp(u, 0.f, 1.f) * 4.f;
+    const int i = std::min(3, static_cast<int>(f));
+    const float w = f - i;
+    std::array<std::uint8_t, 4> c;
+    for (int k = 0; k < 4; ++k) c[k] = static_cast<std::uint8_t>(stops[i][k] + (stops[i + 1][k] - stops[i][k]) * w + 0.5f);
+    return c;
+}
+
+} // namespace
+
+const char* Heatmap::modeName(Mode m) {
+    switch (m) {
+    case Mode::Samples:  return "samples";
+    case Mode::Overdraw: return "overdraw";
+    default:             return "off";
+    }
+}
+
+bool Heatmap::resize(sf::Vector2u size, sf::Vector2f origin) {
+    if (!texture_.resize(size)) return false;
+    size_ = size;
+    origin_ = origin;
+    const std::size_t n = std::size_t(size.x) * size.y;
+    samples_.assign(n, 0);
+    overdraw_.assign(n, 0);
+    stamp_.assign(n, 0);
+    staging_.resize(n * 4);
+    for (int i = 0; i < 256; ++i) ramp_[i] = rampAt(i / 255.f);
+    clear();
+    return true;
+}
+
+void Heatmap::clear() {
+    std::fill(samples_.begin(), samples_.end(), 0u);
+    std::fill(overdraw_.begin(), overdraw_.end(), 0u);
+    peakSamples_ = peakOverdraw_ = 0;
+    totals_ = {};
+    touch(0, 0, static_cast<int>(size_.x) - 1, static_cast<int>(size_.y) - 1);
+}
+
+void Heatmap::touch(int x0, int y0, int x1, int y1) {
+    if (dx1_ < dx0_) { dx0_ = x0; dy0_ = y0; dx1_ = x1; dy1_ = y1; return; }
+    dx0_ = std::min(dx0_, x0); dy0_ = std::min(dy0_, y0);
+    dx1_ = std::max(dx1_, x1); dy1_ = std::max(dy1_, y1);
+}
+
+void Heatmap::segment(sf::Vector2f a, sf::Vector2f b, float stroke) {
+    if (samples_.empty()) return;
+    const sf::Vector2f pa = a - origin_, pb = b - origin_;
+    const int w = static_cast<int>(size_.x), h = static_cast<int>(size_.y);
+
+    const int sx = static_cast<int>(std::floor(pb.x)), sy = static_cast<int>(std::floor(pb.y));
+    if (sx >= 0 && sy >= 0 && sx < w && sy < h) {
+        peakSamples_ = std::max(peakSamples_, ++samples_[std::size_t(sy) * size_.x + sx]);
+        ++totals_.samples;
+        touch(sx, sy, sx, sy);
+    }
+
+    // the capsule, as IndexedCanvas::drawSegment rasterises it
+    const float r = std::max(0.5f, stroke * 0.5f);
+    const int x0 = std::max(0, static_cast<int>(std::floor(std::min(pa.x, pb.x) - r - 1.f)));
+    const int y0 = std::max(0, static_cast<int>(std::floor(std::min(pa.y, pb.y) - r - 1.f)));
+    const int x1 = std::min(w - 1, static_cast<int>(std::ceil(std::max(pa.x, pb.x) + r + 1.f)));
+    const int y1 = std::min(h - 1, static_cast<int>(std::ceil(std::max(pa.y, pb.y) + r + 1.f)));
+    if (x0 > x1 || y0 > y1) return;
+
+    const sf::Vector2f d = pb - pa;
+    const float len2 = d.x * d.x + d.y * d.y;
+    const float inv = len2 > 1e-12f ? 1.f / len2 : 0.f;
+    for (int y = y0; y <= y1; ++y) {
+        const float py = y + 0.5f - pa.y;
+        for (int x = x0; x <= x1; ++x) {
+            const float px = x + 0.5f - pa.x;
+            const float s = std::clamp((px * d.x + py * d.y) * inv, 0.f, 1.f);
+            const float ex = px - d.x * s, ey = py - d.y * s;
+            if (ex * ex + ey * ey >= (r + 0.5f) * (r + 0.5f)) continue;
+            const std::size_t o = std::size_t(y) * size_.x + x;
+            peakOverdraw_ = std::max(peakOverdraw_, ++overdraw_[o]);
+            ++totals_.writes;
+            if (stamp_[o] != frame_) { stamp_[o] = frame_; ++totals_.pixels; }
+        }
+    }
+    touch(x0, y0, x1, y1);
+}
+
+Heatmap::FrameTotals Heatmap::endFrame() {
+    FrameTotals out = totals_;
+    out.peak = mode == Mode::Overdraw ? peakOverdraw_ : peakSamples_;
+    totals_ = {};
+    ++frame_;
+    return out;
+}
+
+void Heatmap::refresh() {
+    if (samples_.empty() || mode == Mode::Off) return;
+    if (shown_ != mode) {   // the other counts: everything changes
+        shown_ = mode;
+        touch(0, 0, static_cast<int>(size_.x) - 1, static_cast<int>(size_.y) - 1);
+    }
+    if (dx1_ < dx0_) return;
+
+    const unsigned w = static_cast<unsigned>(dx1_ - dx0_ + 1), h = static_cast<unsigned>(dy1_ - dy0_ + 1);
+    const std::vector<std::uint32_t>& c = counts();
+    std::uint8_t* out = staging_.data();
+    for (unsigned y = 0; y < h; ++y) {
+        const std::uint32_t* row = c.data() + std::size_t(dy0_ + y) * size_.x + dx0_;
+        for (unsigned x = 0; x < w; ++x, out += 4) {
+            if (!row[x]) { out[0] = out[1] = out[2] = out[3] = 0; continue; }
+            const float u = std::log2(static_cast<float>(row[x]) + 1.f) / kLog2Range;
+            const auto& rc = ramp_[static_cast<std::size_t>(std::min(255.f, u * 255.f))];
+            out[0] = rc[0]; out[1] = rc[1]; out[2] = rc[2]; out[3] = rc[3];
+        }
+    }
+    texture_.update(staging_.data(), { w, h }, { static_cast<unsigned>(dx0_), static_cast<unsigned>(dy0_) });
+    dx0_ = dy0_ = 0;
+    dx1_ = dy1_ = -1;
+}
+
+sf::Sprite Heatmap::sprite() const {
+    sf::Sprite sp(texture_);
+    sp.setPosition(origin_);
+    return sp;
+}
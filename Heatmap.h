@@ -0,0 +1,65 @@
+// Heatmap.h — sample-density and overdraw debug view
+//
+// Every traced sub-segment adds one to the sample count of the logical pixel
+// its end point lands in, and one to the overdraw count of every pixel its
+// stroke touches (the round-capped capsule the canvases draw, at the constant
+// stroke width). The view shows where maxPixelStep packs samples closer than
+// the stroke needs, and where joints and crossings paint the same pixels
+// again. Counts are plain integer increments on the CPU; the overlay is on a
+// fixed log2 scale, so refresh() only re-uploads the region touched since the
+// last call.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class Heatmap {
+public:
+    enum class Mode { Off, Samples, Overdraw, Count };
+    Mode mode = Mode::Off;
+
+    static const char* modeName(Mode m);
+
+    // size logical pixels, the world point `origin` at pixel (0, 0). Drops the counts.
+    bool resize(sf::Vector2u size, sf::Vector2f origin);
+    void clear();
+    bool ready() const { return !samples_.empty(); }
+
+    // One traced sub-segment, world coordinates.
+    void segment(sf::Vector2f a, sf::Vector2f b, float stroke);
+
+    struct FrameTotals {
+        std::uint64_t samples = 0;
+        std::uint64_t writes = 0;    // pixel increments by strokes
+        std::uint64_t pixels = 0;    // distinct pixels those landed on
+        std::uint32_t peak = 0;      // largest count so far in the current mode
+    };
+    // Totals since the previous call.
+    FrameTotals endFrame();
+
+    // Uploads the changed region for the current mode.
+    void refresh();
+
+    // The overlay, in world coordinates.
+    sf::Sprite sprite() const;
+
+private:
+    const std::vector<std::uint32_t>& counts() const { return mode == Mode::Overdraw ? overdraw_ : samples_; }
+    void touch(int x0, int y0, int x1, int y1);
+
+    sf::Vector2u size_{};
+    sf::Vector2f origin_{};
+    std::vector<std::uint32_t> samples_, overdraw_;
+    std::vector<std::uint32_t> stamp_;   // frame of the last write, for distinct pixels
+    std::uint32_t frame_ = 1;
+    FrameTotals totals_;
+    std::uint32_t peakSamples_ = 0, peakOverdraw_ = 0;
+    Mode shown_ = Mode::Off;             // what the texture holds
+
+    int dx0_ = 0, dy0_ = 0, dx1_ = -1, dy1_ = -1;   // changed since the last refresh
+    sf::Texture texture_;
+    std::vector<std::uint8_t> staging_;
+    std::array<std::array<std::uint8_t, 4>, 256> ramp_{};
+};
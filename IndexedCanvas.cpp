@@ -0,0 +1,351 @@
+// IndexedCanvas.cpp — palette-indexed tiled trace canvas (see IndexedCanvas.h)
+
+#include "IndexedCanvas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#include "Spirograph.h"
+
+IndexedCanvas::~IndexedCanvas() { retireShared(); }
+
+bool IndexedCanvas::resize(sf::Vector2u size, sf::Vector2f center, float scale) {
+    size_ = size;
+    center_ = center;
+    scale_ = scale;
+    tilesX_ = (size.x + kTile - 1) / kTile;
+    tilesY_ = (size.y + kTile - 1) / kTile;
+    tiles_.clear();
+    tiles_.resize(std::size_t(tilesX_) * tilesY_);
+    packed_.clear();
+    packed_.resize(tiles_.size());
+    touched_.assign(tiles_.size(), 0);
+    dirty_.assign(tiles_.size(), 1);   // the texture starts out undefined
+
+    const auto& pal = pathPalette();
+    for (std::size_t i = 0; i < pal.size(); ++i)
+        lut_[i] = { pal[i].r, pal[i].g, pal[i].b, pal[i].a };
+    return shmName_.empty() || mapShared();
+}
+
+void IndexedCanvas::clear(bool keepTiles) {
+    if (shmTiles_) {
+        beginWrite();
+        std::memset(static_cast<void*>(shmTiles_), 0, sizeof(Tile) * tiles_.size());
+        std::fill(dirty_.begin(), dirty_.end(), std::uint8_t(1));
+        std::fill(shmDirty_.begin(), shmDirty_.end(), std::uint8_t(1));
+        return;
+    }
+    for (std::size_t i = 0; i < tiles_.size(); ++i) {
+        if (tiles_[i] || !packed_[i].empty()) dirty_[i] = 1;
+        if (keepTiles && tiles_[i]) std::memset(static_cast<void*>(tiles_[i].get()), 0, sizeof(Tile));
+        else tiles_[i].reset();
+        std::vector<std::uint8_t>().swap(packed_[i]);
+    }
+}
+
+IndexedCanvas::Tile& IndexedCanvas::tileAt(unsigned tx, unsigned ty) {
+    const std::size_t i = std::size_t(ty) * tilesX_ + tx;
+    if (shmTiles_) {
+        beginWrite();
+        dirty_[i] = 1;
+        shmDirty_[i] = 1;
+        return shmTiles_[i];
+    }
+    if (!tiles_[i]) {
+        tiles_[i] = std::make_unique<Tile>();
+        if (!packed_[i].empty()) {
+            unpack(packed_[i], *tiles_[i]);
+            std::vector<std::uint8_t>().swap(packed_[i]);
+        }
+        else {
+            std::memset(tiles_[i]->cover, 0, sizeof tiles_[i]->cover);
+            std::memset(tiles_[i]->index, 0, sizeof tiles_[i]->index);
+        }
+    }
+    dirty_[i] = 1;
+    touched_[i] = frame_;
+    return *tiles_[i];
+}
+
+// ---------- cold-tile code ----------
+// Pixels as (cover, index) pairs in row order, one control byte per run:
+//   0x00-0x7F  n+1 empty pixels (both bytes 0)
+//   0x80-0xBF  n+1 copies of the pair that follows
+//   0xC0-0xFF  n+1 literal pairs follow
+void IndexedCanvas::pack(const Tile& t, std::vector<std::uint8_t>& out) {
+    constexpr std::size_t N = kTile * kTile;
+    auto empty = [&t](std::size_t o) { return t.cover[o] == 0 && t.index[o] == 0; };
+    auto same = [&t](std::size_t a, std::size_t b) { return t.cover[a] == t.cover[b] && t.index[a] == t.index[b]; };
+    out.clear();
+    std::size_t o = 0;
+    while (o < N) {
+        std::size_t n = 1;
+        if (empty(o)) {
+            while (o + n < N && n < 128 && empty(o + n)) ++n;
+            out.push_back(static_cast<std::uint8_t>(n - 1));
+            o += n;
+            continue;
+        }
+        while (o + n < N && n < 64 && same(o + n, o)) ++n;
+        if (n >= 2) {
+            out.push_back(static_cast<std::uint8_t>(0x80 | (n - 1)));
+            out.push_back(t.cover[o]);
+            out.push_back(t.index[o]);
+            o += n;
+            continue;
+        }
+        // literals up to the next empty pixel or repeat
+        const std::size_t from = o;
+        n = 0;
+        do { ++n; ++o; } while (o < N && n < 64 && !empty(o) && !(o + 1 < N && same(o + 1, o)));
+        out.push_back(static_cast<std::uint8_t>(0xC0 | (n - 1)));
+        for (std::size_t k = from; k < o; ++k) { out.push_back(t.cover[k]); out.push_back(t.index[k]); }
+    }
+}
+
+void IndexedCanvas::unpack(const std::vector<std::uint8_t>& in, Tile& t) {
+    std::size_t o = 0, i = 0;
+    while (i < in.size()) {
+        const std::uint8_t c = in[i++];
+        if (c < 0x80) {
+            const std::size_t n = c + 1u;
+            std::memset(t.cover + o, 0, n);
+            std::memset(t.index + o, 0, n);
+            o += n;
+        }
+        else if (c < 0xC0) {
+            const std::size_t n = (c & 0x3F) + 1u;
+            std::memset(t.cover + o, in[i], n);
+            std::memset(t.index + o, in[i + 1], n);
+            i += 2;
+            o += n;
+        }
+        else {
+            for (std::size_t n = (c & 0x3F) + 1u; n > 0; --n, ++o, i += 2) {
+                t.cover[o] = in[i];
+                t.index[o] = in[i + 1];
+            }
+        }
+    }
+}
+
+int IndexedCanvas::compressCold(unsigned idleFrames, int maxTiles) {
+    ++frame_;
+    if (shmTiles_) return 0;   // readers map the tiles as they are
+    int n = 0;
+    for (std::size_t i = 0; i < tiles_.size() && n < maxTiles; ++i) {
+        if (!tiles_[i] || dirty_[i] || frame_ - touched_[i] < idleFrames) continue;
+        pack(*tiles_[i], packScratch_);
+        if (packScratch_.size() >= sizeof(Tile)) { touched_[i] = frame_; continue; }   // busy art: stays as is
+        packed_[i].assign(packScratch_.begin(), packScratch_.end());
+        tiles_[i].reset();
+        ++n;
+    }
+    return n;
+}
+
+IndexedCanvas::TileStats IndexedCanvas::tileStats() const {
+    TileStats s;
+    if (shmTiles_) { s.hot = tiles_.size(); s.hotBytes = s.hot * sizeof(Tile); return s; }
+    for (std::size_t i = 0; i < tiles_.size(); ++i) {
+        if (tiles_[i]) { ++s.hot; s.hotBytes += sizeof(Tile); }
+        else if (!packed_[i].empty()) { ++s.cold; s.packedBytes += packed_[i].capacity(); s.coldRawBytes += sizeof(Tile); }
+    }
+    return s;
+}
+
+void IndexedCanvas::drawSegment(sf::Vector2f a, sf::Vector2f b, float stroke, std::uint8_t i0, std::uint8_t i1,
+    float opacity)
+{
+    if (tiles_.empty()) return;
+    opacity = std::clamp(opacity, 0.f, 1.f);
+    const sf::Vector2f half{ size_.x * 0.5f, size_.y * 0.5f };
+    const sf::Vector2f pa = (a - center_) * scale_ + half;
+    const sf::Vector2f pb = (b - center_) * scale_ + half;
+    const float r = std::max(0.5f, stroke * scale_ * 0.5f);
+
+    const int x0 = std::max(0, static_cast<int>(std::floor(std::min(pa.x, pb.x) - r - 1.f)));
+    const int y0 = std::max(0, static_cast<int>(std::floor(std::min(pa.y, pb.y) - r - 1.f)));
+    const int x1 = std::min(static_cast<int>(size_.x) - 1, static_cast<int>(std::ceil(std::max(pa.x, pb.x) + r + 1.f)));
+    const int y1 = std::min(static_cast<int>(size_.y) - 1, static_cast<int>(std::ceil(std::max(pa.y, pb.y) + r + 1.f)));
+    if (x0 > x1 || y0 > y1) return;
+
+    const sf::Vector2f d = pb - pa;
+    const float len2 = d.x * d.x + d.y * d.y;
+    const float inv = len2 > 1e-12f ? 1.f / len2 : 0.f;
+    const int span = static_cast<std::int8_t>(static_cast<std::uint8_t>(i1 - i0));   // shortest way round the cycle
+
+    for (int y = y0; y <= y1; ++y) {
+        const float py = y + 0.5f - pa.y;
+        for (int x = x0; x <= x1; ++x) {
+            const float px = x + 0.5f - pa.x;
+            const float s = std::clamp((px * d.x + py * d.y) * inv, 0.f, 1.f);
+            const float ex = px - d.x * s, ey = py - d.y * s;
+            const float c = r + 0.5f - std::sqrt(ex * ex + ey * ey);
+            if (c <= 0.f) continue;
+
+            const unsigned cn = static_cast<unsigned>(std::min(c, 1.f) * opacity * 255.f + 0.5f);
+            Tile& t = tileAt(static_cast<unsigned>(x) / kTile, static_cast<unsigned>(y) / kTile);
+            const std::size_t o = (y % kTile) * kTile + (x % kTile);
+            const unsigned kept = (t.cover[o] * (255u - cn) + 127u) / 255u;   // old coverage left after "over"
+            if (cn >= kept)
+                t.index[o] = static_cast<std::uint8_t>(i0 + static_cast<int>(std::lround(s * span)));
+            t.cover[o] = static_cast<std::uint8_t>(cn + kept);
+        }
+    }
+}
+
+void IndexedCanvas::expandTile(unsigned tx, unsigned ty, std::uint8_t* rgba, unsigned stride) const {
+    const unsigned w = std::min(kTile, size_.x - tx * kTile);
+    const unsigned h = std::min(kTile, size_.y - ty * kTile);
+    const std::size_t i = std::size_t(ty) * tilesX_ + tx;
+    const Tile* t = tilePtr(i);
+    Tile cold;
+    if (!t && !packed_[i].empty()) { unpack(packed_[i], cold); t = &cold; }
+    for (unsigned y = 0; y < h; ++y) {
+        std::uint8_t* out = rgba + std::size_t(y) * stride * 4;
+        if (!t) { std::memset(out, 0, w * 4); continue; }
+        const std::uint8_t* idx = t->index + y * kTile;
+        const std::uint8_t* cov = t->cover + y * kTile;
+        for (unsigned x = 0; x < w; ++x) {
+            const auto& c = lut_[idx[x]];
+            out[x * 4 + 0] = c[0];
+            out[x * 4 + 1] = c[1];
+            out[x * 4 + 2] = c[2];
+            out[x * 4 + 3] = static_cast<std::uint8_t>((cov[x] * c[3] + 127u) / 255u);
+        }
+    }
+}
+
+int IndexedCanvas::upload(sf::Texture& tex) {
+    std::uint8_t staging[kTile * kTile * 4];
+    int n = 0;
+    for (unsigned ty = 0; ty < tilesY_; ++ty) {
+        for (unsigned tx = 0; tx < tilesX_; ++tx) {
+            std::uint8_t& d = dirty_[std::size_t(ty) * tilesX_ + tx];
+            if (!d) continue;
+            d = 0;
+            const unsigned w = std::min(kTile, size_.x - tx * kTile);
+            const unsigned h = std::min(kTile, size_.y - ty * kTile);
+            expandTile(tx, ty, staging, w);
+            tex.update(staging, { w, h }, { tx * kTile, ty * kTile });
+            ++n;
+        }
+    }
+    return n;
+}
+
+void IndexedCanvas::takeDirty(std::vector<std::uint32_t>& out) {
+    out.clear();
+    for (std::size_t i = 0; i < dirty_.size(); ++i) {
+        if (!dirty_[i]) continue;
+        dirty_[i] = 0;
+        out.push_back(static_cast<std::uint32_t>(i));
+    }
+}
+
+void IndexedCanvas::markAllDirty() {
+    std::fill(dirty_.begin(), dirty_.end(), std::uint8_t(1));
+}
+
+sf::Image IndexedCanvas::toImage() const {
+    std::vector<std::uint8_t> rgba(std::size_t(size_.x) * size_.y * 4);
+    for (unsigned ty = 0; ty < tilesY_; ++ty)
+        for (unsigned tx = 0; tx < tilesX_; ++tx)
+            expandTile(tx, ty, rgba.data() + (std::size_t(ty) * kTile * size_.x + tx * kTile) * 4, size_.x);
+    return sf::Image(size_, rgba.data());
+}
+
+std::size_t IndexedCanvas::bytes() const {
+    const TileStats s = tileStats();
+    return s.hotBytes + s.packedBytes;
+}
+
+// ---------- shared memory ----------
+bool IndexedCanvas::share(const std::string& name) {
+    static_assert(sizeof(Tile) == canvasshm::kTileBytes && kTile == canvasshm::kTile, "shared tile layout");
+    shmName_ = name;
+    return mapShared();
+}
+
+// Tells readers the region is going away before it is unlinked: without
+// this a viewer stays on the old mapping and simply sees seq stop.
+void IndexedCanvas::retireShared() {
+    if (shmHeader_) {
+        shmHeader_->magic = 0;
+        shmHeader_->seq.store(canvasshm::kRetired, std::memory_order_release);
+    }
+    shmHeader_ = nullptr; shmStamps_ = nullptr; shmTiles_ = nullptr;
+    shm_.close();
+}
+
+bool IndexedCanvas::mapShared() {
+    const std::size_t n = tiles_.size();
+    retireShared();
+    shmRetry_ = 0;
+    if (!shm_.create(shmName_, canvasshm::regionBytes(n))) return false;
+
+    // the name may still hold an older canvas: start from zero, then construct in place
+    auto* base = static_cast<std::uint8_t*>(shm_.data());
+    std::memset(base, 0, shm_.size());
+    shmHeader_ = new (base) canvasshm::Header{};
+    shmStamps_ = reinterpret_cast<std::atomic<std::uint64_t>*>(base + canvasshm::stampsOffset());
+    for (std::size_t i = 0; i < n; ++i) new (&shmStamps_[i]) std::atomic<std::uint64_t>(0);
+    shmTiles_ = reinterpret_cast<Tile*>(base + canvasshm::tilesOffset(n));
+
+    // what is already drawn moves over
+    for (std::size_t i = 0; i < n; ++i) {
+        if (tiles_[i]) std::memcpy(static_cast<void*>(&shmTiles_[i]), tiles_[i].get(), sizeof(Tile));
+        else if (!packed_[i].empty()) unpack(packed_[i], shmTiles_[i]);
+        tiles_[i].reset();
+        std::vector<std::uint8_t>().swap(packed_[i]);
+    }
+    shmDirty_.assign(n, 0);
+    shmWriting_ = false;
+
+    canvasshm::Header& h = *shmHeader_;
+    h.version = canvasshm::kVersion;
+    h.width = size_.x;
+    h.height = size_.y;
+    h.tilesX = tilesX_;
+    h.tilesY = tilesY_;
+    h.tileBytes = static_cast<std::uint32_t>(sizeof(Tile));
+    for (std::size_t i = 0; i < lut_.size(); ++i) std::memcpy(h.palette[i], lut_[i].data(), 4);
+    h.seq.store(0, std::memory_order_relaxed);
+    // magic last: readers that see it see a fully initialised header
+    std::atomic_thread_fence(std::memory_order_release);
+    h.magic = canvasshm::kMagic;
+    return true;
+}
+
+void IndexedCanvas::beginWrite() {
+    if (shmWriting_) return;
+    shmWriting_ = true;
+    shmHeader_->seq.fetch_add(1, std::memory_order_relaxed);   // odd: drawing
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void IndexedCanvas::publish() {
+    if (!shmTiles_) {
+        // not mapped after a failed share or resize (on Windows a viewer may
+        // still hold the old region): try again about once a second
+        if (!shmName_.empty() && ++shmRetry_ % 120 == 0) mapShared();
+        return;
+    }
+    if (!shmWriting_) return;
+    const std::uint64_t gen = shmHeader_->seq.load(std::memory_order_relaxed) / 2 + 1;
+    for (std::size_t i = 0; i < shmDirty_.size(); ++i) {
+        if (!shmDirty_[i]) continue;
+        shmDirty_[i] = 0;
+        shmStamps_[i].store(gen, std::memory_order_relaxed);
+    }
+    shmHeader_->seq.store(2 * gen, std::memory_order_release);
+    shmWriting_ = false;
+}
+
+std::uint64_t IndexedCanvas::generation() const {
+    return shmHeader_ ? shmHeader_->seq.load(std::memory_order_relaxed) / 2 : 0;
+}
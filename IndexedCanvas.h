@@ -0,0 +1,137 @@
+// IndexedCanvas.h — CPU trace canvas storing palette index + coverage per pixel
+//
+// The trace colour is a position on a 256-entry hue cycle (pathPalette), so a
+// pixel needs one index byte plus one coverage byte instead of RGBA (and
+// instead of the 8 MSAA samples of the GPU canvas). The canvas is cut into
+// 64x64 tiles that are only allocated once something is drawn on them, and
+// is expanded to RGBA through the palette only for display (dirty tiles) and
+// export.
+//
+// Overlaps keep a single index per pixel: coverage composites as "over", and
+// the index goes to whichever stroke contributes more of the result.
+//
+// Tiles the pen has left behind can be packed (compressCold): a run-length
+// code where long empty runs cost one byte per 128 pixels, so a tile holding
+// a few strokes shrinks to a few hundred bytes. A packed tile is unpacked by
+// the next segment drawn on it and decoded on the fly for upload and export.
+//
+// share() moves the tiles into a named shared-memory region that other
+// processes map read-only (layout and reader in SharedCanvas.h); publish()
+// then ends each frame for them. Shared tiles are all allocated up front and
+// never packed.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SharedCanvas.h"
+
+class IndexedCanvas {
+public:
+    static constexpr unsigned kTile = 64;
+
+    IndexedCanvas() = default;
+    ~IndexedCanvas();   // retires the shared region, if any
+
+    // Canvas of size pixels; world point `center` maps to the canvas centre
+    // and one world unit to `scale` pixels. Drops all content. A shared
+    // canvas gets a new region; false if that could not be created (the
+    // canvas carries on unshared and publish() keeps trying).
+    bool resize(sf::Vector2u size, sf::Vector2f center, float scale);
+    // keepTiles: zero the allocated tiles instead of freeing them, for a
+    // canvas that is drawn on again right away (pooled offline renders).
+    void clear(bool keepTiles = false);
+
+    sf::Vector2u size() const { return size_; }
+    float scale() const { return scale_; }
+
+    // Round-capped segment from a to b (world coordinates), stroke in world
+    // units; the hue index runs from i0 at a to i1 at b. opacity scales the
+    // coverage laid down.
+    void drawSegment(sf::Vector2f a, sf::Vector2f b, float stroke, std::uint8_t i0, std::uint8_t i1,
+        float opacity = 1.f);
+
+    // Expands tiles changed since the last upload into tex (which must be
+    // size() big). Returns the number of tiles uploaded.
+    int upload(sf::Texture& tex);
+
+    // For consumers that upload themselves (PostFx): the tiles changed since
+    // the last upload / takeDirty, as row-major indices, which then count as
+    // uploaded; and one tile as RGBA rows `stride` pixels apart.
+    unsigned tilesX() const { return tilesX_; }
+    unsigned tilesY() const { return tilesY_; }
+    void takeDirty(std::vector<std::uint32_t>& out);
+    void expandTile(unsigned tx, unsigned ty, std::uint8_t* rgba, unsigned stride) const;
+    // Every tile goes out again with the next upload.
+    void markAllDirty();
+
+    // Whole canvas as RGBA (alpha = coverage x palette alpha).
+    sf::Image toImage() const;
+
+    // Packs tiles not drawn on for idleFrames calls (call once per frame) and
+    // already uploaded, at most maxTiles per call. Returns the number packed.
+    int compressCold(unsigned idleFrames, int maxTiles = 64);
+
+    // Moves the canvas into shared memory `name`, keeping what is drawn;
+    // later resizes retire the region (readers reopen) and create a new one.
+    // False if it cannot be created; publish() then retries now and then.
+    bool share(const std::string& name);
+    bool shared() const { return shm_.isOpen(); }
+    // Stamps the tiles drawn on since the last call and lets readers in.
+    // Call once per frame, after drawing.
+    void publish();
+    std::uint64_t generation() const;
+
+    struct TileStats {
+        std::size_t hot = 0, cold = 0;     // allocated tiles, unpacked / packed
+        std::size_t hotBytes = 0;
+        std::size_t packedBytes = 0;       // held by the cold tiles
+        std::size_t coldRawBytes = 0;      // what they take unpacked
+    };
+    TileStats tileStats() const;
+
+    // Bytes held by tiles (packed ones at their packed size), and what the
+    // same area costs as RGBA.
+    std::size_t bytes() const;
+    std::size_t rgbaBytes() const { return std::size_t(size_.x) * size_.y * 4; }
+
+private:
+    struct Tile {
+        std::uint8_t index[kTile * kTile];
+        std::uint8_t cover[kTile * kTile];
+    };
+
+    Tile& tileAt(unsigned tx, unsigned ty);
+    static void pack(const Tile& t, std::vector<std::uint8_t>& out);
+    static void unpack(const std::vector<std::uint8_t>& in, Tile& t);
+    const Tile* tilePtr(std::size_t i) const { return shmTiles_ ? shmTiles_ + i : tiles_[i].get(); }
+    bool mapShared();
+    void retireShared();
+    void beginWrite();
+
+    sf::Vector2u size_{};
+    unsigned tilesX_ = 0, tilesY_ = 0;
+    sf::Vector2f center_{};
+    float scale_ = 1.f;
+    std::vector<std::unique_ptr<Tile>> tiles_;
+    std::vector<std::vector<std::uint8_t>> packed_;   // cold tiles (tiles_[i] null)
+    std::vector<std::uint32_t> touched_;              // frame of the last draw
+    std::uint32_t frame_ = 0;
+    std::vector<std::uint8_t> packScratch_;
+    std::vector<std::uint8_t> dirty_;
+
+    // shared mode: tiles live in shm_ (tiles_ and packed_ stay empty)
+    SharedMemory shm_;
+    std::string shmName_;
+    canvasshm::Header* shmHeader_ = nullptr;
+    std::atomic<std::uint64_t>* shmStamps_ = nullptr;
+    Tile* shmTiles_ = nullptr;
+    std::vector<std::uint8_t> shmDirty_;   // drawn on since the last publish
+    bool shmWriting_ = false;
+    unsigned shmRetry_ = 0;                // publish() calls since a failed mapShared
+    std::array<std::array<std::uint8_t, 4>, 256> lut_{};   // palette as RGBA bytes
+};
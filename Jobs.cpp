@@ -0,0 +1,23 @@
+// Jobs.cpp — cooperative job queue (see Jobs.h)
+
+#include "Jobs.h"
+
+void JobQueue::submit(std::unique_ptr<Job> job) {
+    if (job) jobs_.push_back(std::move(job));
+}
+
+void JobQueue::cancelAll() {
+    if (jobs_.empty()) return;
+    jobs_.erase(jobs_.begin() + 1, jobs_.end());   // never started: nothing to wind down
+    jobs_.front()->cancel();
+}
+
+std::string JobQueue::pump(std::chrono::microseconds budget) {
+    if (jobs_.empty()) return {};
+    Job& job = *jobs_.front();
+    if (!job.step(Job::Clock::now() + budget)) return {};
+
+    std::string result = job.cancelled() ? job.label() + ": cancelled" : job.result();
+    jobs_.pop_front();
+    return result;
+}
@@ -0,0 +1,58 @@
+// Jobs.h — cooperative long-running jobs (exports, full-curve renders, sweeps)
+//
+// A Job is a resumable task written as a small state machine: the main loop
+// calls step() once per frame with a deadline, and the job does a slice of
+// work and keeps its place in member state. Work that cannot be sliced (PNG
+// encoding) is handed to a worker thread and polled from step(). Jobs run one
+// at a time, in submission order, so the frame never blocks on them.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+
+class Job {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~Job() = default;
+
+    // Works until about `deadline`. Returns true when finished — or, once
+    // cancelled, when nothing it started is still running.
+    virtual bool step(Clock::time_point deadline) = 0;
+
+    virtual float progress() const = 0;       // 0..1
+    virtual std::string label() const = 0;    // for the HUD
+
+    void cancel() { cancelled_ = true; }
+    bool cancelled() const { return cancelled_; }
+
+    // What happened, set by the time step() returns true.
+    const std::string& result() const { return result_; }
+
+protected:
+    std::atomic<bool> cancelled_{ false };   // workers may poll it
+    std::string result_;
+};
+
+class JobQueue {
+public:
+    void submit(std::unique_ptr<Job> job);
+
+    bool busy() const { return !jobs_.empty(); }
+    std::size_t queued() const { return jobs_.empty() ? 0 : jobs_.size() - 1; }
+    const Job* current() const { return jobs_.empty() ? nullptr : jobs_.front().get(); }
+
+    // Drops the queued jobs and cancels the running one (which may take a
+    // few more pumps to wind down).
+    void cancelAll();
+
+    // Gives the running job the time until now + budget; moves on to the next
+    // one when it finishes. Returns the finished job's result, else "".
+    std::string pump(std::chrono::microseconds budget);
+
+private:
+    std::deque<std::unique_ptr<Job>> jobs_;
+};
@@ -0,0 +1,79 @@
+// Latency.cpp — input-to-present latency probe and frame pacer (see Latency.h)
+
+#include "Latency.h"
+
+#include <SFML/System.hpp>
+#include <algorithm>
+
+// ---------- LatencyProbe ----------
+void LatencyProbe::Ring::push(Sample x) {
+    if (s.size() < kKeep) { s.push_back(x); return; }
+    s[next] = x;
+    next = (next + 1) % kKeep;
+}
+
+void LatencyProbe::beginPoll() {
+    prevPoll_ = poll_;
+    poll_ = Clock::now();
+}
+
+void LatencyProbe::input() {
+    pending_.push_back(Clock::now());
+}
+
+bool LatencyProbe::presented(bool lowLatency) {
+    if (pending_.empty()) return false;
+    const Clock::time_point now = Clock::now();
+    // the first frame has no previous poll; its own poll start is the best bound
+    const Clock::time_point from = prevPoll_.time_since_epoch().count() ? prevPoll_ : poll_;
+    for (const Clock::time_point at : pending_) {
+        rings_[lowLatency ? 1 : 0].push({
+            std::chrono::duration<float, std::milli>(now - at).count(),
+            std::chrono::duration<float, std::milli>(now - from).count() });
+    }
+    pending_.clear();
+    return true;
+}
+
+LatencyProbe::Stats LatencyProbe::stats(bool lowLatency) const {
+    const std::vector<Sample>& s = rings_[lowLatency ? 1 : 0].s;
+    Stats out;
+    out.count = s.size();
+    if (s.empty()) return out;
+
+    std::vector<float> ms(s.size()), worst(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) { ms[i] = s[i].ms; worst[i] = s[i].worstMs; }
+    auto pct = [](std::vector<float>& v, float p) {
+        const std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(p * v.size()));
+        std::nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+        };
+    out.p50Ms = pct(ms, 0.5f);
+    out.p95Ms = pct(ms, 0.95f);
+    out.worstP50Ms = pct(worst, 0.5f);
+    return out;
+}
+
+// ---------- FramePacer ----------
+void FramePacer::setRate(double hz) {
+    period_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(1.0, hz)));
+    slot_ = {};
+}
+
+void FramePacer::waitForSlot() {
+    const Clock::time_point now = Clock::now();
+    if (slot_.time_since_epoch().count() == 0 || now > slot_ + period_) slot_ = now + period_;   // (re)start the grid
+    const Clock::time_point startAt = slot_ - work_ - margin_;
+    if (startAt > now)
+        sf::sleep(sf::microseconds(static_cast<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(startAt - now).count())));
+    start_ = Clock::now();
+}
+
+void FramePacer::presented() {
+    const Clock::time_point now = Clock::now();
+    // cost estimate: jumps up to a slow frame, decays slowly back down
+    const Clock::duration work = now - start_;
+    work_ = std::max(work, work_ - (work_ - work) / 16);
+    slot_ += period_;
+}
@@ -0,0 +1,71 @@
+// Latency.h — input-to-present latency probe and just-in-time frame pacing
+//
+// SFML events carry no timestamp, so a key press is only known to have
+// arrived somewhere between the previous poll and the poll that returned it.
+// The probe records both ends and, once the frame that applied the key is
+// presented, keeps present-minus-poll (the latency the app adds) and
+// present-minus-previous-poll (the worst case including the queue wait).
+// "Presented" is display() returning; scan-out comes after that and is not
+// visible from here.
+//
+// With setFramerateLimit the limiter sleeps inside display(), i.e. after the
+// frame was built from already-stale input. FramePacer moves that sleep to
+// the front: it waits until just before the next slot, minus the expected
+// frame cost, so events are polled as late as possible.
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+class LatencyProbe {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::size_t count = 0;
+        float p50Ms = 0.f, p95Ms = 0.f;     // poll -> present
+        float worstP50Ms = 0.f;             // previous poll -> present
+    };
+
+    void beginPoll();                       // before this frame's pollEvent loop
+    void input();                           // a key event was just dequeued
+    bool presented(bool lowLatency);        // after display(); true if it took samples
+
+    // Over the most recent kKeep samples taken in the given mode.
+    Stats stats(bool lowLatency) const;
+
+private:
+    static constexpr std::size_t kKeep = 256;
+
+    struct Sample { float ms, worstMs; };
+    struct Ring {
+        std::vector<Sample> s;
+        std::size_t next = 0;
+        void push(Sample x);
+    };
+
+    Clock::time_point prevPoll_{}, poll_{};
+    std::vector<Clock::time_point> pending_;   // dequeue times awaiting their frame
+    Ring rings_[2];                            // [0] normal, [1] low-latency
+};
+
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(double hz = 120.0) { setRate(hz); }
+    void setRate(double hz);
+
+    // Sleeps until the frame should start to be presented at the next slot.
+    void waitForSlot();
+    // After display(): learns the frame cost and advances the slot.
+    void presented();
+
+    float expectedWorkMs() const { return std::chrono::duration<float, std::milli>(work_).count(); }
+
+private:
+    Clock::duration period_{}, work_{ std::chrono::milliseconds(2) };
+    Clock::duration margin_{ std::chrono::microseconds(1000) };   // sleep overshoot allowance
+    Clock::time_point slot_{}, start_{};
+};
@@ -0,0 +1,101 @@
+// MechanismBlur.cpp — motion-blurred mechanism (see MechanismBlur.h)
+
+#include "MechanismBlur.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kTwoPi = 6.2831853f;
+
+sf::Color withAlpha(sf::Color c, float a) {
+    c.a = static_cast<std::uint8_t>(std::clamp(a, 0.f, 1.f) * 255.f + 0.5f);
+    return c;
+}
+
+int segmentsFor(float radius) {
+    return std::clamp(static_cast<int>(radius * 0.35f), 16, 96);
+}
+
+// Ring between r0 and r1 (r0 = 0 gives a filled disc).
+void appendRing(std::vector<sf::Vertex>& out, sf::Vector2f c, float r0, float r1, sf::Color col) {
+    const int segs = segmentsFor(r1);
+    float px = 1.f, py = 0.f;
+    for (int i = 1; i <= segs; ++i) {
+        const float a = kTwoPi * static_cast<float>(i) / segs;
+        const float x = std::cos(a), y = std::sin(a);
+        const sf::Vertex i0{ { c.x + px * r0, c.y + py * r0 }, col };
+        const sf::Vertex o0{ { c.x + px * r1, c.y + py * r1 }, col };
+        const sf::Vertex i1{ { c.x + x * r0, c.y + y * r0 }, col };
+        const sf::Vertex o1{ { c.x + x * r1, c.y + y * r1 }, col };
+        out.push_back(i0); out.push_back(o0); out.push_back(o1);
+        out.push_back(i0); out.push_back(o1); out.push_back(i1);
+        px = x; py = y;
+    }
+}
+
+void appendBar(std::vector<sf::Vertex>& out, sf::Vector2f a, sf::Vector2f b, float width, sf::Color col) {
+    const sf::Vector2f d = b - a;
+    const float len = std::hypot(d.x, d.y);
+    if (len < 1e-4f) return;
+    const sf::Vector2f n{ -d.y / len * width * 0.5f, d.x / len * width * 0.5f };
+    const sf::Vertex v0{ a - n, col }, v1{ a + n, col }, v2{ b + n, col }, v3{ b - n, col };
+    out.push_back(v0); out.push_back(v1); out.push_back(v2);
+    out.push_back(v0); out.push_back(v2); out.push_back(v3);
+}
+
+} // namespace
+
+void MechanismBlur::build(float R, const std::vector<Stage>& chain, sf::Vector2f origin,
+    double t, float frameDt, int selected)
+{
+    verts.clear();
+    if (chain.empty()) return;
+    const int k = std::max(1, samples);
+    const float open = std::max(0.f, shutter * frameDt);
+
+    // first stage that turns too far during the shutter to be sampled
+    std::size_t fast = chain.size();
+    for (std::size_t j = 0; j < chain.size(); ++j) {
+        if (std::fabs(chain[j].speed) * open > fastSweep) { fast = j; break; }
+    }
+
+    // sampled stages: k copies, oldest faintest; total alpha about one opaque copy
+    float weightSum = 0.f;
+    for (int s = 0; s < k; ++s) weightSum += 0.4f + 0.6f * (s + 1) / k;
+    for (int s = 0; s < k; ++s) {
+        const double ts = t - open + open * (s + 1) / k;
+        const sf::Vector2f pen = origin + nestedPenAndCenters_perStageSpeed(R, chain, ts, &centers_);
+        const float a = std::min(1.f, (0.4f + 0.6f * (s + 1) / k) / weightSum * 1.5f);
+        for (std::size_t j = 0; j < fast; ++j) {
+            const sf::Vector2f c = origin + centers_[j];
+            const sf::Color dc = static_cast<int>(j) == selected ? selectedColor : discColor;
+            appendRing(verts, c, chain[j].r, chain[j].r + outline, withAlpha(dc, a));
+            // arms join consecutive centres, the last one the pen (as the plain mechanism)
+            if (j + 1 < fast) appendBar(verts, c, origin + centers_[j + 1], armWidth, withAlpha(armColor, a));
+            else if (j + 1 == chain.size()) appendBar(verts, c, pen, armWidth, withAlpha(armColor, a));
+        }
+    }
+    if (fast == chain.size()) return;
+
+    // fast stage and everything nested in it: the annuli they sweep around the
+    // fast stage's parent (taken at the frame time)
+    nestedPenAndCenters_perStageSpeed(R, chain, t, &centers_);
+    const sf::Vector2f hub = origin + (fast > 0 ? centers_[fast - 1] : sf::Vector2f{ 0.f, 0.f });
+    const float orbit = std::hypot(centers_[fast].x - (fast > 0 ? centers_[fast - 1].x : 0.f),
+                                   centers_[fast].y - (fast > 0 ? centers_[fast - 1].y : 0.f));
+    appendRing(verts, hub, 0.f, orbit, withAlpha(armColor, 0.06f));   // swept arm
+
+    float reach = 0.f;   // how far nested centres stray from the fast stage's centre
+    for (std::size_t j = fast; j < chain.size(); ++j) {
+        if (j > fast)
+            reach += std::hypot(centers_[j].x - centers_[j - 1].x, centers_[j].y - centers_[j - 1].y);
+        const float ext = reach + chain[j].r + outline;
+        const float r0 = std::max(0.f, orbit - ext), r1 = orbit + ext;
+        // share of the annulus one outline covers over time
+        const float cover = (kTwoPi * chain[j].r * outline) / (3.14159f * (r1 * r1 - r0 * r0) + 1e-3f);
+        const sf::Color dc = static_cast<int>(j) == selected ? selectedColor : discColor;
+        appendRing(verts, hub, r0, r1, withAlpha(dc, std::clamp(cover, 0.04f, 0.5f)));
+    }
+}
@@ -0,0 +1,35 @@
+// MechanismBlur.h — motion-blurred mechanism (discs + arms) in one vertex batch
+//
+// Stages whose centre turns less than fastSweep radians while the shutter is
+// open are drawn at `samples` sub-frame times, each copy with a fraction of
+// the alpha (later copies brighter). A faster stage would only strobe, so it
+// and everything nested in it is drawn as the annulus its discs sweep around
+// the fast stage's parent, with alpha from how much of that area a disc
+// outline covers over time; its arm becomes a faint filled disc.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "Spirograph.h"
+
+struct MechanismBlur {
+    int   samples = 8;            // sub-frame times per frame
+    float shutter = 1.f;          // fraction of the last frame the shutter is open
+    float fastSweep = 3.14159f;   // radians per shutter above which a stage is an annulus
+
+    sf::Color discColor{ 140, 200, 255 };
+    sf::Color selectedColor{ 255, 230, 120 };
+    sf::Color armColor{ 120, 200, 140 };
+    float outline = 2.f;          // disc outline thickness (outside the radius, as sf::CircleShape)
+    float armWidth = 1.5f;
+
+    std::vector<sf::Vertex> verts;   // Triangles, rebuilt by build(); capacity is kept
+
+    // Mechanism over (t - shutter * frameDt, t]; origin is the screen centre.
+    void build(float R, const std::vector<Stage>& chain, sf::Vector2f origin,
+        double t, float frameDt, int selected);
+
+private:
+    std::vector<sf::Vector2f> centers_;
+};
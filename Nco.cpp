@@ -0,0 +1,101 @@
+// Nco.cpp — integer phase-accumulator chain evaluation (see Nco.h)
+
+#include "Nco.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kQuarterSegments = 1024;
+const std::int32_t kQuarterSine[kQuarterSegments + 1] = {
+#include "NcoSineTable.inc"
+};
+
+constexpr double kTwoPi = 6.283185307179586476925;
+
+// Fractional part of a turn count as a 64-bit phase. Splitting off the integer
+// part first keeps all 53 bits of the fraction.
+std::uint64_t turnsToPhase(double turns) {
+    double frac = turns - std::floor(turns);
+    if (frac >= 1.0) frac = 0.0;
+    // two 32-bit halves: a double cannot hold all 64 bits of the product at once
+    const double hi = std::floor(frac * 4294967296.0);
+    const double lo = (frac * 4294967296.0 - hi) * 4294967296.0;
+    return (static_cast<std::uint64_t>(hi) << 32) + static_cast<std::uint64_t>(lo);
+}
+
+// sin of a 64-bit phase, Q30. Top 2 bits pick the quadrant, the next 10 the
+// table segment, the next 16 the interpolation weight.
+inline std::int64_t sinQ30(std::uint64_t phase) {
+    const unsigned quadrant = static_cast<unsigned>(phase >> 62);
+    std::uint32_t pos = static_cast<std::uint32_t>(phase >> 36) & ((1u << 26) - 1);
+    if (quadrant & 1u) pos = (1u << 26) - pos;   // falling quarter: mirror
+
+    const std::uint32_t idx = pos >> 16;
+    const std::int64_t frac = pos & 0xffffu;
+    std::int64_t v = kQuarterSine[idx];
+    if (idx < kQuarterSegments)
+        v += ((kQuarterSine[idx + 1] - v) * frac) >> 16;
+    return (quadrant & 2u) ? -v : v;
+}
+
+inline std::int64_t cosQ30(std::uint64_t phase) { return sinQ30(phase + (std::uint64_t(1) << 62)); }
+
+inline sf::Vector2f fromQ16(std::int64_t x, std::int64_t y) {
+    return { static_cast<float>(x) * (1.f / 65536.f), static_cast<float>(y) * (1.f / 65536.f) };
+}
+
+} // namespace
+
+NcoChain compileNco(const CompiledChain& c) {
+    NcoChain n;
+    n.terms.reserve(c.terms.size());
+    for (const auto& t : c.terms) {
+        NcoChain::Term nt;
+        nt.ampQ16 = static_cast<std::int64_t>(std::llround(t.amp * 65536.0));
+        const double turnsPerSecond = t.omega / kTwoPi;
+        const double turnsPerTick = turnsPerSecond / NcoChain::kTickHz;
+        nt.inc = turnsToPhase(turnsPerTick);
+        nt.phase0 = turnsToPhase(t.phase / kTwoPi);
+        n.terms.push_back(nt);
+    }
+    return n;
+}
+
+std::uint64_t ncoTicks(double seconds) {
+    if (!(seconds > 0.0)) return 0;
+    return static_cast<std::uint64_t>(std::llround(seconds * NcoChain::kTickHz));
+}
+
+sf::Vector2f evalPenNco(const NcoChain& c, std::uint64_t tick) {
+    std::int64_t x = 0, y = 0;
+    for (const auto& t : c.terms) {
+        const std::uint64_t ph = t.phase0 + t.inc * tick;   // wraps mod one turn
+        x += (t.ampQ16 * cosQ30(ph)) >> 30;
+        y += (t.ampQ16 * sinQ30(ph)) >> 30;
+    }
+    return fromQ16(x, y);
+}
+
+void evalPenNcoBatch(const NcoChain& c, std::uint64_t tick0, std::uint64_t dTick,
+    std::size_t n, sf::Vector2f* out)
+{
+    constexpr std::size_t kChunk = 256;
+    std::int64_t xs[kChunk], ys[kChunk];
+
+    for (std::size_t base = 0; base < n; base += kChunk) {
+        const std::size_t m = std::min(kChunk, n - base);
+        std::fill(xs, xs + m, 0);
+        std::fill(ys, ys + m, 0);
+        for (const auto& t : c.terms) {
+            std::uint64_t ph = t.phase0 + t.inc * (tick0 + dTick * base);
+            const std::uint64_t step = t.inc * dTick;
+            for (std::size_t k = 0; k < m; ++k, ph += step) {
+                xs[k] += (t.ampQ16 * cosQ30(ph)) >> 30;
+                ys[k] += (t.ampQ16 * sinQ30(ph)) >> 30;
+            }
+        }
+        for (std::size_t k = 0; k < m; ++k) out[base + k] = fromQ16(xs[k], ys[k]);
+    }
+}
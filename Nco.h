@@ -0,0 +1,39 @@
+// Nco.h — integer phase-accumulator (DDS-style) chain evaluation
+//
+// Time is counted in ticks of 2^-20 s. Each term of a CompiledChain becomes a
+// 64-bit phase accumulator (a full turn = 2^64) advanced by a fixed integer
+// increment per tick, and sin/cos come from an interpolated Q30 quarter-wave
+// table. Lengths are Q16 fixed point. Everything after compileNco() is integer
+// arithmetic, so positions are bit-identical on every build and platform;
+// compileNco() itself only uses correctly rounded IEEE double operations.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Spirograph.h"
+
+struct NcoChain {
+    static constexpr int    kTickBits = 20;
+    static constexpr double kTickHz = 1048576.0;   // 2^kTickBits
+
+    struct Term {
+        std::int64_t  ampQ16;   // signed length, pixels * 2^16
+        std::uint64_t phase0;   // turn fraction at tick 0
+        std::uint64_t inc;      // turn fraction per tick (mod one turn)
+    };
+    std::vector<Term> terms;
+};
+
+NcoChain compileNco(const CompiledChain& c);
+
+// Seconds -> nearest tick (negative times clamp to 0).
+std::uint64_t ncoTicks(double seconds);
+
+// Pen local position at a tick.
+sf::Vector2f evalPenNco(const NcoChain& c, std::uint64_t tick);
+
+// n pen samples at tick0 + k*dTick.
+void evalPenNcoBatch(const NcoChain& c, std::uint64_t tick0, std::uint64_t dTick,
+    std::size_t n, sf::Vector2f* out);
@@ -0,0 +1,195 @@
+// Options.cpp — command-line options
+
+#include "Options.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "SampleStream.h"
+
+static void printUsage(const char* exe) {
+    std::cerr
+        << "usage: " << exe << " [options]\n"
+        << "  --stream NAME          publish pen samples to shared memory NAME\n"
+        << "  --stream-capacity N    ring size in samples, at most 16777216 (default 65536)\n"
+        << "  --control PATH         accept commands on Unix-domain socket PATH\n"
+        << "  --alloc-track          count heap allocations per frame and phase (HUD)\n"
+        << "  --alloc-csv FILE       write per-frame allocation counts to FILE\n"
+        << "  --alloc-budget N       allocations allowed per frame (the HUD readout's not counted); exit code 3 if exceeded\n"
+        << "  --slow-frame-ms MS     write a flight-recorder report for frames over MS (default 50, 0 = off)\n"
+        << "  --flight-frames N      frames kept by the flight recorder (default 300)\n"
+        << "  --flight-dir DIR       where flight-recorder reports go (default .)\n"
+        << "  --nco                  trace with the integer phase-accumulator evaluator\n"
+        << "  --indexed-canvas N     trace into a palette-indexed CPU canvas, N px per logical px\n"
+        << "  --share-canvas NAME    keep the indexed canvas in shared memory NAME for viewers\n"
+        << "  --cold-tile-frames N   pack indexed-canvas tiles untouched for N frames (default 240, 0 = off)\n"
+        << "  --low-latency          pace frames just in time instead of with the frame-rate limiter\n"
+        << "  --startup-profile      print time to first frame, broken down by step\n"
+        << "  --frames N             quit after N frames\n"
+        << "  --golden DIR           render reference scenes headless, compare with DIR/*.png\n"
+        << "  --golden-update        with --golden: rewrite the golden images and timings\n"
+        << "                         (none ship: run this once per machine before comparing)\n"
+        << "  --golden-perf          with --golden: fail scenes over 2x their reference time (else only reported)\n"
+        << "  --conformance N        check all evaluators on N random chains, then exit\n"
+        << "  --seed S               random seed for --conformance (default 1)\n"
+        << "  --soak SECONDS         trace SECONDS of simulated time headless, report stability, then exit\n"
+        << "  --soak-warp N          app frames per soak step (default 60)\n"
+        << "  --soak-every SECONDS   simulated seconds between report rows (default 3600)\n"
+        << "  --soak-csv FILE        where the soak report goes (default soak.csv)\n"
+        << "  --animate FILE         render the keyframed timeline in FILE to PNG frames headless, then exit\n"
+        << "  --animate-out PREFIX   frame files are PREFIX00000.png, ... (default anim_)\n"
+        << "  --animate-threads N    render threads (default: one per core)\n"
+        << "  --animate-scale S      PNG pixels per logical pixel (default 1)\n"
+        << "  --compose FILE         pack the figures listed in sheet FILE onto one page, write HPGL, then exit\n"
+        << "  --compose-out FILE     where the plot goes (default sheet.hpgl)\n";
+}
+
+bool parseOptions(int argc, char** argv, AppOptions& out) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto takesValue = [&] {
+            if (!v) { std::cerr << a << " needs a value\n"; printUsage(argv[0]); return false; }
+            ++i; return true;
+            };
+
+        if (!std::strcmp(a, "--stream")) {
+            if (!takesValue()) return false;
+            out.streamName = v;
+        }
+        else if (!std::strcmp(a, "--stream-capacity")) {
+            if (!takesValue()) return false;
+            char* end = nullptr;
+            const unsigned long n = std::strtoul(v, &end, 10);
+            if (end == v || *end || *v == '-' || n < 2 || n > stream::kMaxCapacity) {
+                std::cerr << "--stream-capacity must be 2.." << stream::kMaxCapacity << "\n";
+                return false;
+            }
+            out.streamCapacity = static_cast<std::uint32_t>(n);
+        }
+        else if (!std::strcmp(a, "--control")) {
+            if (!takesValue()) return false;
+            out.controlPath = v;
+        }
+        else if (!std::strcmp(a, "--alloc-track")) {
+            out.allocTrack = true;
+        }
+        else if (!std::strcmp(a, "--alloc-csv")) {
+            if (!takesValue()) return false;
+            out.allocCsv = v;
+            out.allocTrack = true;
+        }
+        else if (!std::strcmp(a, "--alloc-budget")) {
+            if (!takesValue()) return false;
+            out.allocBudget = std::strtol(v, nullptr, 10);
+            out.allocTrack = true;
+        }
+        else if (!std::strcmp(a, "--slow-frame-ms")) {
+            if (!takesValue()) return false;
+            out.slowFrameMs = std::strtod(v, nullptr);
+        }
+        else if (!std::strcmp(a, "--flight-frames")) {
+            if (!takesValue()) return false;
+            out.flightFrames = std::max(1L, std::strtol(v, nullptr, 10));
+        }
+        else if (!std::strcmp(a, "--flight-dir")) {
+            if (!takesValue()) return false;
+            out.flightDir = v;
+        }
+        else if (!std::strcmp(a, "--nco")) {
+            out.nco = true;
+        }
+        else if (!std::strcmp(a, "--low-latency")) {
+            out.lowLatency = true;
+        }
+        else if (!std::strcmp(a, "--indexed-canvas")) {
+            if (!takesValue()) return false;
+            out.indexedScale = static_cast<unsigned>(std::clamp(std::strtol(v, nullptr, 10), 0L, 16L));
+        }
+        else if (!std::strcmp(a, "--share-canvas")) {
+            if (!takesValue()) return false;
+            out.shareCanvas = v;
+        }
+        else if (!std::strcmp(a, "--cold-tile-frames")) {
+            if (!takesValue()) return false;
+            out.coldTileFrames = static_cast<unsigned>(std::max(0L, std::strtol(v, nullptr, 10)));
+        }
+        else if (!std::strcmp(a, "--startup-profile")) {
+            out.startupProfile = true;
+        }
+        else if (!std::strcmp(a, "--frames")) {
+            if (!takesValue()) return false;
+            out.maxFrames = std::strtol(v, nullptr, 10);
+        }
+        else if (!std::strcmp(a, "--golden")) {
+            if (!takesValue()) return false;
+            out.goldenDir = v;
+        }
+        else if (!std::strcmp(a, "--golden-update")) {
+            out.goldenUpdate = true;
+        }
+        else if (!std::strcmp(a, "--golden-perf")) {
+            out.goldenPerf = true;
+        }
+        else if (!std::strcmp(a, "--conformance")) {
+            if (!takesValue()) return false;
+            out.conformanceChains = std::atoi(v);
+        }
+        else if (!std::strcmp(a, "--seed")) {
+            if (!takesValue()) return false;
+            out.seed = static_cast<std::uint32_t>(std::strtoul(v, nullptr, 10));
+        }
+        else if (!std::strcmp(a, "--soak")) {
+            if (!takesValue()) return false;
+            out.soak.seconds = std::max(0.0, std::strtod(v, nullptr));
+        }
+        else if (!std::strcmp(a, "--soak-warp")) {
+            if (!takesValue()) return false;
+            out.soak.warp = std::max(1L, std::strtol(v, nullptr, 10));
+        }
+        else if (!std::strcmp(a, "--soak-every")) {
+            if (!takesValue()) return false;
+            out.soak.every = std::max(1.0, std::strtod(v, nullptr));
+        }
+        else if (!std::strcmp(a, "--soak-csv")) {
+            if (!takesValue()) return false;
+            out.soak.csvPath = v;
+        }
+        else if (!std::strcmp(a, "--animate")) {
+            if (!takesValue()) return false;
+            out.animate.timeline = v;
+        }
+        else if (!std::strcmp(a, "--animate-out")) {
+            if (!takesValue()) return false;
+            out.animate.prefix = v;
+        }
+        else if (!std::strcmp(a, "--animate-threads")) {
+            if (!takesValue()) return false;
+            out.animate.threads = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        }
+        else if (!std::strcmp(a, "--animate-scale")) {
+            if (!takesValue()) return false;
+            out.animate.scale = std::clamp(static_cast<float>(std::strtod(v, nullptr)), 0.25f, 8.f);
+        }
+        else if (!std::strcmp(a, "--compose")) {
+            if (!takesValue()) return false;
+            out.compose.sheet = v;
+        }
+        else if (!std::strcmp(a, "--compose-out")) {
+            if (!takesValue()) return false;
+            out.compose.out = v;
+        }
+        else if (!std::strcmp(a, "--help") || !std::strcmp(a, "-h")) {
+            printUsage(argv[0]);
+            return false;
+        }
+        else {
+            std::cerr << "unknown option: " << a << "\n";
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+// Options.h — command-line options
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Animation.h"
+#include "Sheet.h"
+#include "Soak.h"
+
+struct AppOptions {
+    // shared-memory sample stream (empty = off)
+    std::string   streamName;
+    std::uint32_t streamCapacity = 1u << 16;
+
+    // Unix-domain control socket path (empty = off)
+    std::string   controlPath;
+
+    // heap allocation tracking
+    bool          allocTrack = false;
+    std::string   allocCsv;            // per-frame rows (implies allocTrack)
+    long          allocBudget = -1;    // max allocations per frame; -1 = none
+
+    // flight recorder: reports a frame slower than slowFrameMs (0 = never)
+    double        slowFrameMs = 50.0;
+    long          flightFrames = 300;
+    std::string   flightDir = ".";
+
+    // start with the integer NCO evaluator for the trace (key N toggles)
+    bool          nco = false;
+
+    // palette-indexed CPU canvas at N pixels per logical pixel (0 = GPU canvas)
+    unsigned      indexedScale = 0;
+    // pack indexed-canvas tiles not drawn on for this many frames (0 = never)
+    unsigned      coldTileFrames = 240;
+    // keep the indexed canvas in shared memory under this name (empty = off)
+    std::string   shareCanvas;
+
+    // start with just-in-time frame pacing instead of the frame-rate limiter (key L toggles)
+    bool          lowLatency = false;
+
+    // print time-to-first-frame by startup step
+    bool          startupProfile = false;
+
+    // quit after this many frames (0 = run until closed)
+    long          maxFrames = 0;
+
+    // headless golden-image run instead of the window (empty = off)
+    std::string   goldenDir;
+    bool          goldenUpdate = false;
+    bool          goldenPerf = false;    // SLOW fails the run, not just reported
+
+    // evaluator cross-check instead of the window (0 = off)
+    int           conformanceChains = 0;
+    std::uint32_t seed = 1;
+
+    // headless long-run stability check instead of the window (seconds = 0: off)
+    SoakOptions   soak;
+
+    // headless offline animation instead of the window (empty timeline = off)
+    AnimateOptions animate;
+
+    // headless plotter sheet of many figures instead of the window (empty sheet = off)
+    SheetOptions  compose;
+};
+
+// Returns false (after printing usage) on a bad command line.
+bool parseOptions(int argc, char** argv, AppOptions& out);
@@ -0,0 +1,373 @@
+// PostFx.cpp — CPU glow, soft blur and vignette (see PostFx.h)
+
+#include "PostFx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "IndexedCanvas.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POSTFX_SSE2 1
+#endif
+
+namespace {
+
+constexpr unsigned kTile = IndexedCanvas::kTile;
+constexpr std::size_t kTileBytes = std::size_t(kTile) * kTile * 4;
+constexpr int kMaxBox = static_cast<int>(kTile) / 4;   // two passes reach 2 * box: one ring of tiles
+constexpr int kVigLut = 1024;                           // over squared distance 0..2
+
+// One RGBA pixel as four floats (0..255, premultiplied inside the kernels).
+#ifdef POSTFX_SSE2
+struct V4 {
+    __m128 v;
+
+    static V4 zero() { return { _mm_setzero_ps() }; }
+    static V4 splat(float f) { return { _mm_set1_ps(f) }; }
+    static V4 set(float r, float g, float b, float a) { return { _mm_setr_ps(r, g, b, a) }; }
+    static V4 load8(const std::uint8_t* p) {
+        int bits;
+        std::memcpy(&bits, p, 4);
+        const __m128i z = _mm_setzero_si128();
+        return { _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), z), z)) };
+    }
+    // rounded, clamped to 0..255
+    void store8(std::uint8_t* p) const {
+        const __m128i i = _mm_cvtps_epi32(v);
+        const __m128i w = _mm_packs_epi32(i, i);
+        const int bits = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+        std::memcpy(p, &bits, 4);
+    }
+    V4 alpha() const { return { _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)) }; }
+    // rgb from this, alpha from w
+    V4 withAlpha(V4 w) const {
+        const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        return { _mm_or_ps(_mm_and_ps(mask, v), _mm_andnot_ps(mask, w.v)) };
+    }
+};
+inline V4 operator+(V4 a, V4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline V4 operator-(V4 a, V4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline V4 operator*(V4 a, V4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline V4 vmin(V4 a, V4 b) { return { _mm_min_ps(a.v, b.v) }; }
+#else
+struct V4 {
+    float v[4];
+
+    static V4 zero() { return { { 0.f, 0.f, 0.f, 0.f } }; }
+    static V4 splat(float f) { return { { f, f, f, f } }; }
+    static V4 set(float r, float g, float b, float a) { return { { r, g, b, a } }; }
+    static V4 load8(const std::uint8_t* p) { return { { float(p[0]), float(p[1]), float(p[2]), float(p[3]) } }; }
+    void store8(std::uint8_t* p) const {
+        for (int c = 0; c < 4; ++c) p[c] = static_cast<std::uint8_t>(std::clamp(v[c] + 0.5f, 0.f, 255.f));
+    }
+    V4 alpha() const { return splat(v[3]); }
+    V4 withAlpha(V4 w) const { return { { v[0], v[1], v[2], w.v[3] } }; }
+};
+inline V4 operator+(V4 a, V4 b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+inline V4 operator-(V4 a, V4 b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+inline V4 operator*(V4 a, V4 b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+inline V4 vmin(V4 a, V4 b) {
+    return { { std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]) } };
+}
+#endif
+
+// Box of half-width b along one row, zero outside [0, n): a running sum.
+void boxAcross(const V4* in, V4* out, int n, int b) {
+    const V4 k = V4::splat(1.f / (2 * b + 1));
+    V4 sum = V4::zero();
+    for (int i = 0; i < std::min(b, n); ++i) sum = sum + in[i];
+    for (int i = 0; i < n; ++i) {
+        if (i + b < n) sum = sum + in[i + b];
+        out[i] = sum * k;
+        if (i >= b) sum = sum - in[i - b];
+    }
+}
+
+// The same down columns [x0, x0 + w) of a stride-wide image, n rows: one
+// running sum per column, rows streamed in order.
+void boxDown(const V4* in, V4* out, int stride, int n, int x0, int w, int b, std::vector<V4>& sums) {
+    const V4 k = V4::splat(1.f / (2 * b + 1));
+    sums.assign(static_cast<std::size_t>(w), V4::zero());
+    for (int y = 0; y < std::min(b, n); ++y) {
+        const V4* row = in + std::size_t(y) * stride + x0;
+        for (int x = 0; x < w; ++x) sums[x] = sums[x] + row[x];
+    }
+    for (int y = 0; y < n; ++y) {
+        if (y + b < n) {
+            const V4* add = in + std::size_t(y + b) * stride + x0;
+            for (int x = 0; x < w; ++x) sums[x] = sums[x] + add[x];
+        }
+        V4* o = out + std::size_t(y) * stride + x0;
+        for (int x = 0; x < w; ++x) o[x] = sums[x] * k;
+        if (y >= b) {
+            const V4* sub = in + std::size_t(y - b) * stride + x0;
+            for (int x = 0; x < w; ++x) sums[x] = sums[x] - sub[x];
+        }
+    }
+}
+
+int boxFor(float radius, float scale) {
+    // two passes of half-width b reach 2b
+    return std::clamp(static_cast<int>(std::lround(radius * scale * 0.5f)), 1, kMaxBox);
+}
+
+} // namespace
+
+struct PostFx::Scratch {
+    std::vector<V4> src, t1, t2;   // the tile and its halo
+    std::vector<V4> glow, soft;    // results for the tile itself
+    std::vector<V4> sums;
+};
+
+PostFx::PostFx(unsigned threads) : threads_(threads) {
+    if (threads_ == 0) {
+        const unsigned cores = std::thread::hardware_concurrency();
+        threads_ = cores > 1 ? cores - 1 : 0;
+    }
+}
+
+void PostFx::startWorkers() {
+    scratch_.push_back(std::make_unique<Scratch>());
+    for (unsigned i = 0; i < threads_; ++i) {
+        scratch_.push_back(std::make_unique<Scratch>());
+        workers_.emplace_back([this, i] { workerLoop(i + 1); });
+    }
+}
+
+PostFx::~PostFx() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    start_.notify_all();
+    for (std::thread& w : workers_) w.join();
+}
+
+std::string PostFx::effectsName(unsigned e) {
+    std::string s;
+    auto add = [&](unsigned bit, const char* name) {
+        if (!(e & bit)) return;
+        if (!s.empty()) s += " + ";
+        s += name;
+    };
+    add(Glow, "glow");
+    add(Soft, "soft");
+    add(Vignette, "vignette");
+    return s.empty() ? "off" : s;
+}
+
+void PostFx::parallelFor(std::size_t n, const std::function<void(std::size_t, Scratch&)>& fn) {
+    if (n == 0) return;
+    if (workers_.empty() || n == 1) {
+        for (std::size_t i = 0; i < n; ++i) fn(i, *scratch_[0]);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        jobSize_ = n;
+        next_ = 0;
+        running_ = static_cast<unsigned>(workers_.size());
+        ++generation_;
+    }
+    start_.notify_all();
+    for (std::size_t i; (i = next_++) < n; ) fn(i, *scratch_[0]);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return running_ == 0; });
+    job_ = nullptr;
+}
+
+void PostFx::workerLoop(std::size_t id) {
+    std::uint64_t seen = 0;
+    for (;;) {
+        const std::function<void(std::size_t, Scratch&)>* job;
+        std::size_t n;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&] { return quit_ || generation_ != seen; });
+            if (quit_) return;
+            seen = generation_;
+            job = job_;
+            n = jobSize_;
+        }
+        for (std::size_t i; (i = next_++) < n; ) (*job)(i, *scratch_[id]);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--running_ == 0) done_.notify_one();
+    }
+}
+
+void PostFx::resize(sf::Vector2u size, float scale) {
+    size_ = size;
+    scale_ = scale;
+    tilesX_ = (size.x + kTile - 1) / kTile;
+    tilesY_ = (size.y + kTile - 1) / kTile;
+    const std::size_t tiles = std::size_t(tilesX_) * tilesY_;
+    src_.assign(std::size_t(size.x) * size.y * 4, 0);
+    nonEmpty_.assign(tiles, 0);
+    redo_.assign(tiles, 0);
+
+    // squared distance from the centre, 1 at the middle of each edge
+    vigCol_.resize(size.x);
+    vigRow_.resize(size.y);
+    for (unsigned x = 0; x < size.x; ++x) { const float u = (x + 0.5f) / size.x * 2.f - 1.f; vigCol_[x] = u * u; }
+    for (unsigned y = 0; y < size.y; ++y) { const float u = (y + 0.5f) / size.y * 2.f - 1.f; vigRow_[y] = u * u; }
+    full_ = true;
+}
+
+void PostFx::processTile(std::uint32_t tile, Scratch& s, std::uint8_t* out) const {
+    const unsigned tx = tile % tilesX_, ty = tile / tilesX_;
+    const int x0 = static_cast<int>(tx * kTile), y0 = static_cast<int>(ty * kTile);
+    const int w = static_cast<int>(std::min(kTile, size_.x - tx * kTile));
+    const int h = static_cast<int>(std::min(kTile, size_.y - ty * kTile));
+    const int H = halo_;
+    const int rw = w + 2 * H, rh = h + 2 * H;
+    const int cw = static_cast<int>(size_.x), ch = static_cast<int>(size_.y);
+
+    const V4 bg = V4::set(background.r, background.g, background.b, 255.f);
+    const V4 one = V4::splat(1.f), inv255 = V4::splat(1.f / 255.f), opaque = V4::splat(255.f);
+    const bool vig = (effects_ & Vignette) != 0;
+    auto vignetted = [&](V4 c, int x, int y) {
+        if (!vig) return c;
+        const float d2 = vigCol_[x0 + x] + vigRow_[y0 + y];
+        const int i = std::min(kVigLut - 1, static_cast<int>(d2 * (kVigLut / 2)));
+        return (c * V4::splat(vigLut_[i])).withAlpha(opaque);
+    };
+
+    // nothing drawn within reach: background only
+    bool any = false;
+    const int ring = H > 0 ? 1 : 0;
+    for (int ny = static_cast<int>(ty) - ring; ny <= static_cast<int>(ty) + ring && !any; ++ny)
+        for (int nx = static_cast<int>(tx) - ring; nx <= static_cast<int>(tx) + ring && !any; ++nx)
+            if (nx >= 0 && ny >= 0 && nx < static_cast<int>(tilesX_) && ny < static_cast<int>(tilesY_))
+                any = nonEmpty_[std::size_t(ny) * tilesX_ + nx] != 0;
+    if (!any) {
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x) vignetted(bg, x, y).store8(out + (std::size_t(y) * w + x) * 4);
+        return;
+    }
+
+    // the tile and its halo, premultiplied; zero off the canvas
+    s.src.resize(std::size_t(rw) * rh);
+    for (int y = 0; y < rh; ++y) {
+        V4* row = s.src.data() + std::size_t(y) * rw;
+        const int sy = y0 - H + y;
+        if (sy < 0 || sy >= ch) { std::fill(row, row + rw, V4::zero()); continue; }
+        const std::uint8_t* in = src_.data() + std::size_t(sy) * cw * 4;
+        for (int x = 0; x < rw; ++x) {
+            const int sx = x0 - H + x;
+            if (sx < 0 || sx >= cw) { row[x] = V4::zero(); continue; }
+            const V4 c = V4::load8(in + std::size_t(sx) * 4);
+            row[x] = c * (c.alpha() * inv255).withAlpha(one);
+        }
+    }
+
+    // across on every row of the region, down on the tile's columns only
+    auto blur = [&](int b, std::vector<V4>& dst) {
+        s.t1.resize(s.src.size());
+        s.t2.resize(s.src.size());
+        for (int y = 0; y < rh; ++y) {
+            boxAcross(s.src.data() + std::size_t(y) * rw, s.t1.data() + std::size_t(y) * rw, rw, b);
+            boxAcross(s.t1.data() + std::size_t(y) * rw, s.t2.data() + std::size_t(y) * rw, rw, b);
+        }
+        boxDown(s.t2.data(), s.t1.data(), rw, rh, H, w, b, s.sums);
+        boxDown(s.t1.data(), s.t2.data(), rw, rh, H, w, b, s.sums);
+        dst.resize(std::size_t(w) * h);
+        for (int y = 0; y < h; ++y)
+            std::copy_n(s.t2.data() + std::size_t(H + y) * rw + H, w, dst.data() + std::size_t(y) * w);
+    };
+    const bool glow = (effects_ & Glow) != 0, soft = (effects_ & Soft) != 0;
+    if (glow) blur(glowBox_, s.glow);
+    if (soft) blur(softBox_, s.soft);
+
+    const V4 strength = V4::splat(glowStrength);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const std::size_t i = std::size_t(y) * w + x;
+            V4 p = soft ? s.soft[i] : s.src[std::size_t(H + y) * rw + H + x];
+            if (glow) p = vmin(p + s.glow[i] * strength * (one - p.alpha() * inv255), opaque);
+            const V4 c = p + bg * (one - p.alpha() * inv255);   // over the background: alpha 255
+            vignetted(c, x, y).store8(out + i * 4);
+        }
+    }
+}
+
+int PostFx::upload(IndexedCanvas& canvas, sf::Texture& tex) {
+    const auto t0 = std::chrono::steady_clock::now();
+    if (scratch_.empty()) startWorkers();   // first use: nothing runs until effects are on
+    if (canvas.size() != size_ || canvas.scale() != scale_) resize(canvas.size(), canvas.scale());
+    canvas.takeDirty(dirty_);
+    const std::size_t tiles = std::size_t(tilesX_) * tilesY_;
+    const bool full = full_;
+    if (full) {
+        // settings or size changed, or the canvas went on while effects were off
+        glowBox_ = boxFor(glowRadius, scale_);
+        softBox_ = boxFor(softRadius, scale_);
+        halo_ = 2 * std::max((effects_ & Glow) ? glowBox_ : 0, (effects_ & Soft) ? softBox_ : 0);
+        vigLut_.resize(kVigLut);
+        for (int i = 0; i < kVigLut; ++i) {
+            const float t = std::clamp((i * (2.f / kVigLut) - 0.3f) / 1.7f, 0.f, 1.f);
+            vigLut_[i] = 1.f - std::clamp(vignette, 0.f, 1.f) * t * t * (3.f - 2.f * t);
+        }
+        dirty_.resize(tiles);
+        for (std::size_t i = 0; i < tiles; ++i) dirty_[i] = static_cast<std::uint32_t>(i);
+        full_ = false;
+    }
+    if (dirty_.empty()) {
+        lastTiles_ = 0;
+        lastMs_ = 0.0;
+        return 0;
+    }
+
+    // the changed tiles into the RGBA copy
+    parallelFor(dirty_.size(), [&](std::size_t k, Scratch&) {
+        const std::uint32_t i = dirty_[k];
+        const unsigned tx = i % tilesX_, ty = i / tilesX_;
+        const unsigned w = std::min(kTile, size_.x - tx * kTile), h = std::min(kTile, size_.y - ty * kTile);
+        std::uint8_t* dst = src_.data() + (std::size_t(ty) * kTile * size_.x + std::size_t(tx) * kTile) * 4;
+        canvas.expandTile(tx, ty, dst, size_.x);
+        bool any = false;
+        for (unsigned y = 0; y < h && !any; ++y)
+            for (unsigned x = 0; x < w; ++x)
+                if (dst[(std::size_t(y) * size_.x + x) * 4 + 3]) { any = true; break; }
+        nonEmpty_[i] = any;
+        });
+
+    // every output tile a changed tile's blur reaches
+    redoList_.clear();
+    if (full) {
+        for (std::size_t i = 0; i < tiles; ++i) redoList_.push_back(static_cast<std::uint32_t>(i));
+    }
+    else {
+        std::fill(redo_.begin(), redo_.end(), std::uint8_t(0));
+        const int ring = halo_ > 0 ? 1 : 0;
+        for (const std::uint32_t i : dirty_) {
+            const int tx = static_cast<int>(i % tilesX_), ty = static_cast<int>(i / tilesX_);
+            for (int ny = std::max(0, ty - ring); ny <= std::min(static_cast<int>(tilesY_) - 1, ty + ring); ++ny)
+                for (int nx = std::max(0, tx - ring); nx <= std::min(static_cast<int>(tilesX_) - 1, tx + ring); ++nx)
+                    redo_[std::size_t(ny) * tilesX_ + nx] = 1;
+        }
+        for (std::size_t i = 0; i < tiles; ++i)
+            if (redo_[i]) redoList_.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    out_.resize(redoList_.size() * kTileBytes);
+    parallelFor(redoList_.size(), [&](std::size_t k, Scratch& s) {
+        processTile(redoList_[k], s, out_.data() + k * kTileBytes);
+        });
+
+    for (std::size_t k = 0; k < redoList_.size(); ++k) {
+        const unsigned tx = redoList_[k] % tilesX_, ty = redoList_[k] / tilesX_;
+        const unsigned w = std::min(kTile, size_.x - tx * kTile), h = std::min(kTile, size_.y - ty * kTile);
+        tex.update(out_.data() + k * kTileBytes, { w, h }, { tx * kTile, ty * kTile });
+    }
+
+    lastTiles_ = static_cast<int>(redoList_.size());
+    lastMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return lastTiles_;
+}
@@ -0,0 +1,103 @@
+// PostFx.h — CPU post effects on the indexed trace canvas: glow, soft blur, vignette
+//
+// Sits between the IndexedCanvas and its texture in place of
+// IndexedCanvas::upload, so machines without a usable GPU get the effects
+// too. The canvas is expanded into an RGBA copy, tile by tile as tiles
+// change; every output tile within reach of a changed tile (the blur
+// support) is then recomputed and uploaded, and nothing else is.
+//
+// Both blurs are separable: two box passes across, then two down (a tent,
+// close enough to a Gaussian for a glow), as running sums, so the cost per
+// pixel does not grow with the radius. A pixel is one 4-float SIMD vector
+// (SSE2 where available), and tiles are shared between a small pool of
+// worker threads and the calling thread. The result is opaque: the trace
+// over `background`, then the vignette, which darkens towards the corners
+// through a lookup table on the squared distance.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class IndexedCanvas;
+
+class PostFx {
+public:
+    enum Effect : unsigned { Glow = 1, Soft = 2, Vignette = 4 };
+
+    // Lengths in logical pixels (scaled by the canvas scale).
+    float glowRadius = 10.f;      // reach of the glow
+    float glowStrength = 1.1f;
+    float softRadius = 1.f;       // reach of the soft blur
+    float vignette = 0.6f;        // darkening in the corners, 0..1
+    sf::Color background{ 15, 18, 22 };
+
+    // The pool starts with the first upload, so an unused PostFx costs nothing.
+    explicit PostFx(unsigned threads = 0);   // 0: one per core, less one
+    ~PostFx();
+    PostFx(const PostFx&) = delete;
+    PostFx& operator=(const PostFx&) = delete;
+
+    unsigned effects() const { return effects_; }
+    bool active() const { return effects_ != 0; }
+    // Recomputes everything on the next upload.
+    void setEffects(unsigned e) { effects_ = e; full_ = true; }
+    void invalidate() { full_ = true; }
+    static std::string effectsName(unsigned e);
+
+    // Takes the canvas's changed tiles and updates tex (canvas-sized).
+    // Returns the number of tiles uploaded.
+    int upload(IndexedCanvas& canvas, sf::Texture& tex);
+
+    // Last upload: wall time and output tiles recomputed.
+    double lastMs() const { return lastMs_; }
+    int lastTiles() const { return lastTiles_; }
+
+private:
+    struct Scratch;   // per-thread blur buffers
+
+    void startWorkers();
+    void resize(sf::Vector2u size, float scale);
+    void processTile(std::uint32_t tile, Scratch& s, std::uint8_t* out) const;
+    void parallelFor(std::size_t n, const std::function<void(std::size_t, Scratch&)>& fn);
+    void workerLoop(std::size_t id);
+
+    unsigned effects_ = 0;
+    bool full_ = true;
+
+    sf::Vector2u size_{};
+    float scale_ = 0.f;
+    unsigned tilesX_ = 0, tilesY_ = 0;
+    int glowBox_ = 0, softBox_ = 0, halo_ = 0;   // box half-widths, support (canvas pixels)
+
+    std::vector<std::uint8_t>  src_;        // the canvas as RGBA
+    std::vector<std::uint8_t>  nonEmpty_;   // per tile: any coverage in src_
+    std::vector<std::uint8_t>  redo_;       // per tile, this upload
+    std::vector<std::uint32_t> dirty_, redoList_;
+    std::vector<std::uint8_t>  out_;        // redoList_.size() tiles, RGBA
+    std::vector<float>         vigRow_, vigCol_;     // squared normalised distance parts
+    std::vector<float>         vigLut_;
+
+    double lastMs_ = 0.0;
+    int lastTiles_ = 0;
+
+    // pool: job n items, handed out by next_; the caller works too
+    unsigned threads_ = 0;   // workers besides the caller
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Scratch>> scratch_;   // [0] is the caller's
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    const std::function<void(std::size_t, Scratch&)>* job_ = nullptr;
+    std::size_t jobSize_ = 0;
+    std::uint64_t generation_ = 0;
+    std::atomic<std::size_t> next_{ 0 };
+    unsigned running_ = 0;
+    bool quit_ = false;
+};
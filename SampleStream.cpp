@@ -0,0 +1,133 @@
+// SampleStream.cpp — shared-memory pen sample ring (see SampleStream.h)
+
+#include "SampleStream.h"
+
+#include <cstring>
+#include <new>
+
+using namespace stream;
+
+static std::uint64_t packFloats(float lo, float hi) {
+    std::uint32_t a, b;
+    std::memcpy(&a, &lo, 4); std::memcpy(&b, &hi, 4);
+    return static_cast<std::uint64_t>(a) | (static_cast<std::uint64_t>(b) << 32);
+}
+
+static void unpackFloats(std::uint64_t v, float& lo, float& hi) {
+    auto a = static_cast<std::uint32_t>(v), b = static_cast<std::uint32_t>(v >> 32);
+    std::memcpy(&lo, &a, 4); std::memcpy(&hi, &b, 4);
+}
+
+// ---------- writer ----------
+bool SampleStreamWriter::open(const std::string& name, std::uint32_t capacity) {
+    if (capacity < 2) capacity = 2;
+    if (capacity > kMaxCapacity) return false;
+    std::uint32_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    const std::size_t bytes = sizeof(Header) + sizeof(Slot) * cap;
+    if (!m_shm.create(name, bytes)) return false;
+
+    // fresh mapping is zero-filled; construct the atomics in place
+    auto* base = static_cast<unsigned char*>(m_shm.data());
+    m_header = new (base) Header{};
+    m_slots = reinterpret_cast<Slot*>(base + sizeof(Header));
+    for (std::uint32_t i = 0; i < cap; ++i) new (&m_slots[i]) Slot{};
+
+    m_header->capacity = cap;
+    m_header->slotSize = sizeof(Slot);
+    m_header->version = kVersion;
+    m_header->head.store(0, std::memory_order_relaxed);
+    m_mask = cap - 1;
+    m_next = 0;
+    // magic last: readers that see it see a fully initialised header
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = kMagic;
+    return true;
+}
+
+void SampleStreamWriter::publish(double t, float x, float y, std::uint32_t rgba) {
+    if (!m_header) return;
+    const std::uint64_t idx = m_next++;
+    Slot& s = m_slots[idx & m_mask];
+
+    std::uint64_t tBits;
+    std::memcpy(&tBits, &t, 8);
+
+    s.seq.store(2 * idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.t.store(tBits, std::memory_order_relaxed);
+    s.xy.store(packFloats(x, y), std::memory_order_relaxed);
+    s.rgba.store(rgba, std::memory_order_relaxed);
+    s.seq.store(2 * idx + 2, std::memory_order_release);
+
+    m_header->head.store(idx + 1, std::memory_order_release);
+}
+
+// ---------- reader ----------
+bool SampleStreamReader::open(const std::string& name, bool fromOldest) {
+    if (!m_shm.open(name, true)) return false;
+    if (m_shm.size() < sizeof(Header)) { m_shm.close(); return false; }
+
+    const auto* base = static_cast<const unsigned char*>(m_shm.data());
+    const auto* h = reinterpret_cast<const Header*>(base);
+    if (h->magic != kMagic || h->version != kVersion || h->slotSize != sizeof(Slot)
+        || m_shm.size() < sizeof(Header) + sizeof(Slot) * std::size_t(h->capacity)) {
+        m_shm.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    m_header = h;
+    m_slots = reinterpret_cast<const Slot*>(base + sizeof(Header));
+    m_capacity = h->capacity;
+    const std::uint64_t headNow = head();
+    m_next = fromOldest ? (headNow > m_capacity ? headNow - m_capacity : 0) : headNow;
+    m_dropped = 0;
+    return true;
+}
+
+std::uint64_t SampleStreamReader::head() const {
+    return m_header ? m_header->head.load(std::memory_order_acquire) : 0;
+}
+
+std::size_t SampleStreamReader::poll(std::vector<Sample>& out, std::size_t maxCount) {
+    if (!m_header) return 0;
+    std::size_t got = 0;
+    std::uint64_t headNow = head();
+
+    while (got < maxCount && m_next < headNow) {
+        // lapped: skip to the oldest slot that can still be intact
+        if (headNow - m_next > m_capacity) {
+            const std::uint64_t oldest = headNow - m_capacity;
+            m_dropped += oldest - m_next;
+            m_next = oldest;
+        }
+
+        const Slot& s = m_slots[m_next & (m_capacity - 1)];
+        const std::uint64_t want = 2 * m_next + 2;
+        const std::uint64_t s1 = s.seq.load(std::memory_order_acquire);
+        if (s1 != want) {
+            if (s1 < want) break;              // producer has not finished it yet
+            ++m_dropped; ++m_next; continue;   // already overwritten
+        }
+
+        Sample smp;
+        const std::uint64_t tBits = s.t.load(std::memory_order_relaxed);
+        const std::uint64_t xy = s.xy.load(std::memory_order_relaxed);
+        const std::uint64_t rgba = s.rgba.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) != s1) {
+            ++m_dropped; ++m_next; continue;   // torn: overwritten while copying
+        }
+
+        std::memcpy(&smp.t, &tBits, 8);
+        unpackFloats(xy, smp.x, smp.y);
+        smp.rgba = static_cast<std::uint32_t>(rgba);
+        out.push_back(smp);
+        ++got; ++m_next;
+
+        if (m_next == headNow) headNow = head();
+    }
+    return got;
+}
@@ -0,0 +1,89 @@
+// SampleStream.h — pen samples published to shared memory for other processes
+//
+// Layout: Header followed by a power-of-two ring of Slots. The single producer
+// never waits; each slot is a small seqlock (odd = being written, even = done,
+// value encodes which sample index it holds), so any number of readers can
+// follow at their own pace and detect when they have been lapped.
+// No SFML here: the reader tool builds against this header alone.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SharedMemory.h"
+
+namespace stream {
+
+constexpr std::uint32_t kMagic = 0x53505353; // 'SPSS'
+constexpr std::uint32_t kVersion = 1;
+// Largest ring open() makes: 2^24 slots of 32 bytes is 512 MiB.
+constexpr std::uint32_t kMaxCapacity = 1u << 24;
+
+struct Sample {
+    double        t = 0.0;   // simulation time (s)
+    float         x = 0.f;   // pen position, window pixels
+    float         y = 0.f;
+    std::uint32_t rgba = 0;  // sf::Color::toInteger() layout
+};
+
+// Payload is stored as relaxed atomics so the seqlock is race-free by the
+// letter of the memory model; on x86/ARM64 these are plain loads/stores.
+struct Slot {
+    std::atomic<std::uint64_t> seq;
+    std::atomic<std::uint64_t> t;    // bit pattern of Sample::t
+    std::atomic<std::uint64_t> xy;   // x in low word, y in high word
+    std::atomic<std::uint64_t> rgba;
+};
+
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t capacity;   // slots, power of two
+    std::uint32_t slotSize;
+    alignas(64) std::atomic<std::uint64_t> head; // samples published so far
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+    "shared-memory ring needs lock-free 64-bit atomics");
+
+} // namespace stream
+
+// Producer side (the app).
+class SampleStreamWriter {
+public:
+    // Capacity rounds up to a power of two; above stream::kMaxCapacity fails.
+    bool open(const std::string& name, std::uint32_t capacity);
+    bool isOpen() const { return m_header != nullptr; }
+    void publish(double t, float x, float y, std::uint32_t rgba);
+
+private:
+    SharedMemory    m_shm;
+    stream::Header* m_header = nullptr;
+    stream::Slot*   m_slots = nullptr;
+    std::uint64_t   m_mask = 0;
+    std::uint64_t   m_next = 0;
+};
+
+// Consumer side. Starts at the newest sample unless fromOldest is set.
+class SampleStreamReader {
+public:
+    bool open(const std::string& name, bool fromOldest = false);
+    bool isOpen() const { return m_header != nullptr; }
+
+    // Appends up to maxCount samples to out; returns how many were appended.
+    std::size_t poll(std::vector<stream::Sample>& out, std::size_t maxCount);
+
+    std::uint64_t dropped() const { return m_dropped; }
+    std::uint64_t position() const { return m_next; }
+    std::uint64_t head() const;
+
+private:
+    SharedMemory          m_shm;
+    const stream::Header* m_header = nullptr;
+    const stream::Slot*   m_slots = nullptr;
+    std::uint64_t         m_capacity = 0;
+    std::uint64_t         m_next = 0;
+    std::uint64_t         m_dropped = 0;
+};
@@ -0,0 +1,82 @@
+// SharedCanvas.cpp — reader for the shared indexed canvas (see SharedCanvas.h)
+//
+// The writer side lives in IndexedCanvas (share / publish).
+
+#include "SharedCanvas.h"
+
+#include <algorithm>
+
+using namespace canvasshm;
+
+bool SharedCanvasReader::open(const std::string& name) {
+    if (!m_shm.open(name, true)) return false;
+    if (m_shm.size() < sizeof(Header)) { m_shm.close(); return false; }
+
+    const auto* base = static_cast<const std::uint8_t*>(m_shm.data());
+    const auto* h = reinterpret_cast<const Header*>(base);
+    const std::size_t tiles = std::size_t(h->tilesX) * h->tilesY;
+    if (h->magic != kMagic || h->version != kVersion || h->tileBytes != kTileBytes
+        || m_shm.size() < regionBytes(tiles)) {
+        m_shm.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    m_header = h;
+    m_stamps = reinterpret_cast<const std::atomic<std::uint64_t>*>(base + stampsOffset());
+    m_tiles = base + tilesOffset(tiles);
+    m_seen = 0;
+    m_torn = 0;
+    m_needAll = true;
+    return true;
+}
+
+std::size_t SharedCanvasReader::poll(std::vector<std::uint8_t>& rgba) {
+    if (!m_header) return 0;
+    const Header& h = *m_header;
+    const std::uint64_t s0 = h.seq.load(std::memory_order_acquire);
+    if (s0 == kRetired || h.magic != kMagic) {
+        // let go at once: on Windows the app cannot make the new region while
+        // this one is still mapped
+        m_header = nullptr; m_stamps = nullptr; m_tiles = nullptr;
+        m_shm.close();
+        return kReopen;
+    }
+    if (s0 & 1) return 0;   // mid-frame
+    const std::uint64_t gen = s0 / 2;
+    const std::size_t bytes = std::size_t(h.width) * h.height * 4;
+    const bool all = m_needAll || rgba.size() != bytes;
+    if (!all && gen == m_seen) return 0;
+
+    const std::size_t tiles = std::size_t(h.tilesX) * h.tilesY;
+    rgba.resize(bytes);
+    m_pending.clear();
+    for (std::size_t i = 0; i < tiles; ++i)
+        if (all || m_stamps[i].load(std::memory_order_relaxed) > m_seen) m_pending.push_back(static_cast<std::uint32_t>(i));
+
+    for (const std::uint32_t i : m_pending) {
+        const std::uint32_t tx = i % h.tilesX, ty = i / h.tilesX;
+        const std::uint32_t w = std::min(kTile, h.width - tx * kTile), th = std::min(kTile, h.height - ty * kTile);
+        const std::uint8_t* index = m_tiles + std::size_t(i) * kTileBytes;
+        const std::uint8_t* cover = index + kTile * kTile;
+        for (std::uint32_t y = 0; y < th; ++y) {
+            std::uint8_t* out = rgba.data() + ((std::size_t(ty) * kTile + y) * h.width + std::size_t(tx) * kTile) * 4;
+            for (std::uint32_t x = 0; x < w; ++x) {
+                const std::uint8_t* c = h.palette[index[y * kTile + x]];
+                out[x * 4 + 0] = c[0];
+                out[x * 4 + 1] = c[1];
+                out[x * 4 + 2] = c[2];
+                out[x * 4 + 3] = static_cast<std::uint8_t>((cover[y * kTile + x] * c[3] + 127u) / 255u);
+            }
+        }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (h.seq.load(std::memory_order_relaxed) != s0) {
+        ++m_torn;   // drawn over while copying: the same tiles (and more) next time
+        return 0;
+    }
+    m_seen = gen;
+    m_needAll = false;
+    return m_pending.size();
+}
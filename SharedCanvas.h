@@ -0,0 +1,89 @@
+// SharedCanvas.h — the indexed trace canvas, mapped by other processes
+//
+// With --share-canvas NAME the IndexedCanvas keeps its tiles in a named
+// shared-memory region instead of the heap, so a viewer or encoder maps the
+// very pixels the tracer draws into: nothing is serialised or sent per frame.
+//
+// Layout: Header, then one generation stamp per tile, then the tiles (index
+// plane, then coverage plane, kTile x kTile each, row by row). The header's
+// seq is a seqlock over the whole canvas: odd while the app draws, and
+// generation = seq / 2 once it is done. Each tile's stamp is the generation
+// in which it last changed, so the stamps are the dirty map: a reader that
+// has seen generation g copies only tiles stamped after g, and any number of
+// readers can follow at their own pace without the app clearing anything.
+// A copy that overlaps a write (seq moved) is thrown away and retried.
+// When the app replaces the region (a resize) or exits, it first stores
+// kRetired in seq and clears magic; readers then close and open the name
+// again.
+// No SFML here: the viewer tool builds against this header alone.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SharedMemory.h"
+
+namespace canvasshm {
+
+constexpr std::uint32_t kMagic = 0x54435053; // 'SPCT'
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kTile = 64;
+constexpr std::size_t   kTileBytes = std::size_t(kTile) * kTile * 2;   // index + coverage
+constexpr std::uint64_t kRetired = ~std::uint64_t(0);   // seq of a region the app has left
+
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t width, height;     // canvas pixels
+    std::uint32_t tilesX, tilesY;
+    std::uint32_t tileBytes;
+    std::uint32_t reserved;
+    std::uint8_t  palette[256][4];   // RGBA; pixel alpha = coverage x palette alpha
+    alignas(64) std::atomic<std::uint64_t> seq;
+};
+
+inline std::size_t stampsOffset() { return (sizeof(Header) + 63) & ~std::size_t(63); }
+inline std::size_t tilesOffset(std::size_t tiles) {
+    return (stampsOffset() + tiles * sizeof(std::uint64_t) + 63) & ~std::size_t(63);
+}
+inline std::size_t regionBytes(std::size_t tiles) { return tilesOffset(tiles) + tiles * kTileBytes; }
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+    "shared canvas needs lock-free 64-bit atomics");
+
+} // namespace canvasshm
+
+// Consumer side: mirrors the canvas into an RGBA buffer.
+class SharedCanvasReader {
+public:
+    bool open(const std::string& name);
+    bool isOpen() const { return m_header != nullptr; }
+
+    std::uint32_t width() const { return m_header ? m_header->width : 0; }
+    std::uint32_t height() const { return m_header ? m_header->height : 0; }
+
+    // Returned by poll when the app has retired the region: the reader has
+    // closed it; open(name) again for the new one.
+    static constexpr std::size_t kReopen = static_cast<std::size_t>(-1);
+
+    // Expands the tiles changed since the last successful poll into rgba
+    // (width x height x 4, resized on first use). Returns the tiles copied;
+    // 0 when nothing changed or the app was drawing (call again later), or
+    // kReopen.
+    std::size_t poll(std::vector<std::uint8_t>& rgba);
+
+    std::uint64_t generation() const { return m_seen; }
+    std::uint64_t torn() const { return m_torn; }
+
+private:
+    SharedMemory                      m_shm;
+    const canvasshm::Header*          m_header = nullptr;
+    const std::atomic<std::uint64_t>* m_stamps = nullptr;
+    const std::uint8_t*               m_tiles = nullptr;
+    std::uint64_t                     m_seen = 0;
+    std::uint64_t                     m_torn = 0;
+    bool                              m_needAll = true;
+    std::vector<std::uint32_t>        m_pending;   // scratch: tiles to copy this poll
+};
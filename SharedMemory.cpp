@@ -0,0 +1,92 @@
+// SharedMemory.cpp — named shared-memory region (POSIX shm / Win32 file mapping)
+
+#include "SharedMemory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::~SharedMemory() { close(); }
+
+#ifdef _WIN32
+
+static std::string winName(const std::string& name) { return "Local\\" + name; }
+
+bool SharedMemory::create(const std::string& name, std::size_t bytes) {
+    close();
+    const auto size64 = static_cast<unsigned long long>(bytes);
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffffu),
+        winName(name).c_str());
+    if (!h) return false;
+    if (GetLastError() == ERROR_ALREADY_EXISTS) { CloseHandle(h); return false; }
+    void* p = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!p) { CloseHandle(h); return false; }
+    m_handle = h; m_data = p; m_size = bytes; m_name = name; m_owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, bool readOnly) {
+    close();
+    const DWORD access = readOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS;
+    HANDLE h = OpenFileMappingA(access, FALSE, winName(name).c_str());
+    if (!h) return false;
+    void* p = MapViewOfFile(h, access, 0, 0, 0);
+    if (!p) { CloseHandle(h); return false; }
+    MEMORY_BASIC_INFORMATION info{};
+    VirtualQuery(p, &info, sizeof(info));
+    m_handle = h; m_data = p; m_size = info.RegionSize; m_name = name; m_owner = false;
+    return true;
+}
+
+void SharedMemory::close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_handle) CloseHandle(static_cast<HANDLE>(m_handle));
+    m_data = nullptr; m_handle = nullptr; m_size = 0; m_owner = false;
+}
+
+#else
+
+static std::string posixName(const std::string& name) { return "/" + name; }
+
+bool SharedMemory::create(const std::string& name, std::size_t bytes) {
+    close();
+    const std::string path = posixName(name);
+    int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) { ::close(fd); shm_unlink(path.c_str()); return false; }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { shm_unlink(path.c_str()); return false; }
+    m_data = p; m_size = bytes; m_name = name; m_owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, bool readOnly) {
+    close();
+    int fd = shm_open(posixName(name).c_str(), readOnly ? O_RDONLY : O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    const auto bytes = static_cast<std::size_t>(st.st_size);
+    void* p = mmap(nullptr, bytes, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    m_data = p; m_size = bytes; m_name = name; m_owner = false;
+    return true;
+}
+
+void SharedMemory::close() {
+    if (m_data) munmap(m_data, m_size);
+    if (m_owner) shm_unlink(posixName(m_name).c_str());
+    m_data = nullptr; m_size = 0; m_owner = false;
+}
+
+#endif
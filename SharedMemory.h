@@ -0,0 +1,38 @@
+// SharedMemory.h — named shared-memory region (POSIX shm / Win32 file mapping)
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Owns one mapping of a named region. The creator unlinks the name on
+// destruction; readers only unmap. Names are given without the leading '/'.
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // Creates (or truncates) the region read/write. On Windows a region lives
+    // while anyone maps it, so a name still mapped by a reader fails rather
+    // than handing back the old region at its old size.
+    bool create(const std::string& name, std::size_t bytes);
+    // Maps an existing region. Size is taken from the region itself.
+    bool open(const std::string& name, bool readOnly = true);
+    void close();
+
+    void*       data() { return m_data; }
+    const void* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool        isOpen() const { return m_data != nullptr; }
+
+private:
+    void*       m_data = nullptr;
+    std::size_t m_size = 0;
+    std::string m_name;
+    bool        m_owner = false;
+#ifdef _WIN32
+    void*       m_handle = nullptr;
+#endif
+};
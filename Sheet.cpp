@@ -0,0 +1,411 @@
+// Sheet.cpp — the sheet composer (see Sheet.h)
+
+#include "Sheet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+#include "Spirograph.h"
+
+namespace {
+
+using Vec2d = sf::Vector2<double>;
+
+constexpr double      kUnitsPerMm = 40.0;           // HPGL plotter units
+constexpr std::size_t kMaxSamples = std::size_t(1) << 22;   // per figure
+constexpr int         kMaxPen = 8;
+constexpr std::size_t kPointsPerPd = 64;            // points per PD command
+
+struct Figure {
+    const CompiledChain* chain = nullptr;
+    std::string path;
+    int    pen = 1;
+    double reachPx = 0.0;   // bounding radius, logical pixels
+    double period = 0.0;
+    bool   closed = false;
+    Vec2d  centre;          // mm, y up
+    bool   placed = false;
+};
+
+struct Sheet {
+    double w = 420.0, h = 297.0, margin = 10.0, gap = 2.0, scale = 0.1, step = 0.2;
+    std::map<std::string, CompiledChain> chains;   // by path, shared by copies
+    std::vector<Figure> figures;
+};
+
+double dist(Vec2d a, Vec2d b) { return std::hypot(a.x - b.x, a.y - b.y); }
+
+bool loadSheet(const std::string& path, Sheet& out, std::string& error) {
+    std::ifstream in(path);
+    if (!in) { error = "cannot open"; return false; }
+    const std::filesystem::path dir = std::filesystem::path(path).parent_path();
+
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ls(line);
+        std::string word;
+        if (!(ls >> word)) continue;
+
+        auto fail = [&](const std::string& what) {
+            error = "line " + std::to_string(lineNo) + ": " + what;
+            return false;
+        };
+
+        if (word == "page") {
+            if (!(ls >> out.w >> out.h) || out.w <= 0.0 || out.h <= 0.0) return fail("bad page size");
+        }
+        else if (word == "margin") {
+            if (!(ls >> out.margin) || out.margin < 0.0) return fail("bad margin");
+        }
+        else if (word == "gap") {
+            if (!(ls >> out.gap) || out.gap < 0.0) return fail("bad gap");
+        }
+        else if (word == "scale") {
+            if (!(ls >> out.scale) || out.scale <= 0.0) return fail("bad scale");
+        }
+        else if (word == "step") {
+            if (!(ls >> out.step) || out.step <= 0.0) return fail("bad step");
+        }
+        else if (word == "figure") {
+            std::string file;
+            int pen = 1, copies = 1;
+            if (!(ls >> file)) return fail("missing chain file");
+            if (ls >> pen) ls >> copies;
+            if (pen < 1 || pen > kMaxPen) return fail("pen must be 1.." + std::to_string(kMaxPen));
+            if (copies < 1) return fail("bad copies");
+
+            auto it = out.chains.find(file);
+            if (it == out.chains.end()) {
+                const std::filesystem::path p = dir / file;   // an absolute file replaces dir
+                std::ifstream cin(p);
+                if (!cin) return fail("cannot open " + p.string());
+                float R = 0.f;
+                std::vector<Stage> chain;
+                std::string why;
+                if (!readChain(cin, R, chain, why)) return fail(p.string() + ": " + why);
+                it = out.chains.emplace(file, compileChain(R, chain)).first;
+            }
+            Figure f;
+            f.chain = &it->second;
+            f.path = file;
+            f.pen = pen;
+            for (const auto& term : f.chain->terms) f.reachPx += std::fabs(term.amp);
+            f.period = curvePeriod(*f.chain, kMaxCurveSeconds);
+            f.closed = f.period < kMaxCurveSeconds;
+            out.figures.insert(out.figures.end(), static_cast<std::size_t>(copies), f);
+        }
+        else return fail("unknown keyword '" + word + "'");
+    }
+    if (out.w <= 2.0 * out.margin || out.h <= 2.0 * out.margin) { error = "margins fill the page"; return false; }
+    return true;
+}
+
+// Samples one figure into plotter units, y up, repeats dropped.
+void sampleFigure(const Figure& f, const Sheet& sheet, std::vector<sf::Vector2f>& buf,
+    std::vector<sf::Vector2<long>>& pts) {
+    double arcRate = 0.0;   // px/s bound on the pen speed
+    for (const auto& term : f.chain->terms) arcRate += std::fabs(term.amp * term.omega);
+    const double stepPx = sheet.step / sheet.scale;
+    std::size_t n = 16;
+    if (arcRate > 0.0 && f.period > 0.0)
+        n = std::clamp(static_cast<std::size_t>(std::ceil(f.period * arcRate / stepPx)), n, kMaxSamples);
+    buf.resize(n + 1);
+    evalPenBatch(*f.chain, 0.0, f.period / n, n + 1, buf.data());
+
+    pts.clear();
+    for (const sf::Vector2f p : buf) {
+        const sf::Vector2<long> q{ std::lround((f.centre.x + p.x * sheet.scale) * kUnitsPerMm),
+            std::lround((f.centre.y - p.y * sheet.scale) * kUnitsPerMm) };
+        if (pts.empty() || q.x != pts.back().x || q.y != pts.back().y) pts.push_back(q);
+    }
+}
+
+} // namespace
+
+std::size_t packCircles(const std::vector<double>& radius, double w, double h, double gap,
+    std::vector<Vec2d>& centres, std::vector<bool>& placed) {
+    const std::size_t n = radius.size();
+    centres.assign(n, {});
+    placed.assign(n, false);
+    if (n == 0) return 0;
+
+    // Circles grown by half the gap just touch when they are gap apart; the
+    // rectangle grows by as much, so they still reach its edge.
+    constexpr double eps = 1e-9;
+    const double g = gap * 0.5;
+    const double left = -g, bottom = -g, right = w + g, top = h + g;
+    double rMax = 0.0;
+    for (const double r : radius) rMax = std::max(rMax, r + g);
+
+    // placed circles by centre; a cell is as wide as the largest circle, so
+    // overlaps are within one cell and touching pairs within two
+    const double cell = std::max(2.0 * rMax, eps);
+    const int gx = std::max(1, static_cast<int>(std::ceil((right - left) / cell)));
+    const int gy = std::max(1, static_cast<int>(std::ceil((top - bottom) / cell)));
+    std::vector<std::vector<std::size_t>> grid(std::size_t(gx) * gy);
+    auto cellOf = [&](Vec2d p) {
+        return sf::Vector2i{ std::clamp(static_cast<int>((p.x - left) / cell), 0, gx - 1),
+            std::clamp(static_cast<int>((p.y - bottom) / cell), 0, gy - 1) };
+    };
+    auto forNear = [&](Vec2d p, int reach, auto&& fn) {
+        const sf::Vector2i c = cellOf(p);
+        for (int y = std::max(0, c.y - reach); y <= std::min(gy - 1, c.y + reach); ++y)
+            for (int x = std::max(0, c.x - reach); x <= std::min(gx - 1, c.x + reach); ++x)
+                for (const std::size_t j : grid[std::size_t(y) * gx + x]) fn(j);
+    };
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return radius[a] > radius[b]; });
+
+    auto fits = [&](Vec2d p, double rho) {
+        if (p.x - rho < left - eps || p.x + rho > right + eps || p.y - rho < bottom - eps || p.y + rho > top + eps)
+            return false;
+        bool clear = true;
+        forNear(p, 1, [&](std::size_t j) {
+            const double need = rho + radius[j] + g - eps;
+            const Vec2d d = p - centres[j];
+            if (d.x * d.x + d.y * d.y < need * need) clear = false;
+            });
+        return clear;
+    };
+    // Spots for a circle of grown radius rho touching placed circle j and a
+    // wall or another placed circle (where the grown rims cross).
+    auto around = [&](std::size_t j, double rho, auto&& fn) {
+        const Vec2d cj = centres[j];
+        const double dj = rho + radius[j] + g;
+        for (const double x : { left + rho, right - rho }) {
+            const double dx = x - cj.x;
+            if (std::fabs(dx) > dj) continue;
+            const double dy = std::sqrt(dj * dj - dx * dx);
+            fn(Vec2d{ x, cj.y - dy });
+            fn(Vec2d{ x, cj.y + dy });
+        }
+        for (const double y : { bottom + rho, top - rho }) {
+            const double dy = y - cj.y;
+            if (std::fabs(dy) > dj) continue;
+            const double dx = std::sqrt(dj * dj - dy * dy);
+            fn(Vec2d{ cj.x - dx, y });
+            fn(Vec2d{ cj.x + dx, y });
+        }
+        forNear(cj, 2, [&](std::size_t k) {
+            if (k == j) return;
+            const double dk = rho + radius[k] + g;
+            const Vec2d e = centres[k] - cj;
+            const double d = std::hypot(e.x, e.y);
+            if (d <= eps || d > dj + dk || d < std::fabs(dj - dk)) return;
+            const double a = (dj * dj - dk * dk + d * d) / (2.0 * d);
+            const double hh = std::sqrt(std::max(0.0, dj * dj - a * a));
+            const Vec2d mid = cj + e * (a / d);
+            const Vec2d perp{ -e.y / d * hh, e.x / d * hh };
+            fn(mid + perp);
+            fn(mid - perp);
+            });
+    };
+
+    // Only circles with room beside them for the smallest circle are tried:
+    // if that one cannot touch j anywhere, no larger one can, and placements
+    // only take room away. Keeps each placement to the packing's frontier.
+    const double rhoMin = radius[order.back()] + g;
+    std::vector<std::size_t> open;
+    std::size_t count = 0;
+    for (const std::size_t i : order) {
+        const double rho = radius[i] + g;
+        Vec2d best;
+        bool found = false;
+        // lowest, then leftmost
+        auto consider = [&](Vec2d p) {
+            if (found && (p.y > best.y + eps || (p.y > best.y - eps && p.x >= best.x))) return;
+            if (fits(p, rho)) { best = p; found = true; }
+        };
+        for (const double y : { bottom + rho, top - rho })
+            for (const double x : { left + rho, right - rho }) consider({ x, y });
+        for (const std::size_t j : open) around(j, rho, consider);
+        if (!found) continue;
+
+        centres[i] = best;
+        placed[i] = true;
+        ++count;
+        const sf::Vector2i c = cellOf(best);
+        grid[std::size_t(c.y) * gx + c.x].push_back(i);
+        open.push_back(i);
+
+        // the new circle may have closed off its neighbours
+        open.erase(std::remove_if(open.begin(), open.end(), [&](std::size_t j) {
+            const Vec2d d = centres[j] - best;
+            if (std::hypot(d.x, d.y) > rho + radius[j] + g + 2.0 * rhoMin) return false;
+            bool room = false;
+            around(j, rhoMin, [&](Vec2d p) { if (!room && fits(p, rhoMin)) room = true; });
+            return !room;
+            }), open.end());
+    }
+    return count;
+}
+
+std::vector<std::size_t> planTour(const std::vector<Vec2d>& points, Vec2d from) {
+    const std::size_t n = points.size();
+    std::vector<std::size_t> order;
+    order.reserve(n);
+
+    std::vector<bool> used(n, false);
+    Vec2d at = from;
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t best = 0;
+        double bestD = -1.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            if (used[j]) continue;
+            const Vec2d d = points[j] - at;
+            const double d2 = d.x * d.x + d.y * d.y;
+            if (bestD < 0.0 || d2 < bestD) { bestD = d2; best = j; }
+        }
+        used[best] = true;
+        order.push_back(best);
+        at = points[best];
+    }
+
+    // Reversing order[i..j] swaps the edges (i-1, i) and (j, j+1) for
+    // (i-1, j) and (i, j+1); from stands before order[0], nothing after the end.
+    const auto pt = [&](std::size_t k) { return k == 0 ? from : points[order[k - 1]]; };   // k: 0 = from
+    for (bool improved = true; improved; ) {
+        improved = false;
+        for (std::size_t i = 1; i <= n; ++i) {
+            for (std::size_t j = i + 1; j <= n; ++j) {
+                double delta = dist(pt(i - 1), pt(j)) - dist(pt(i - 1), pt(i));
+                if (j < n) delta += dist(pt(i), pt(j + 1)) - dist(pt(j), pt(j + 1));
+                if (delta < -1e-9) {
+                    std::reverse(order.begin() + (i - 1), order.begin() + j);
+                    improved = true;
+                }
+            }
+        }
+    }
+    return order;
+}
+
+int runSheet(const SheetOptions& opts) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); };
+
+    auto t0 = Clock::now();
+    Sheet sheet;
+    std::string error;
+    if (!loadSheet(opts.sheet, sheet, error)) {
+        std::cerr << opts.sheet << ": " << error << "\n";
+        return 2;
+    }
+    std::cout << "sheet: " << sheet.figures.size() << " figures from " << sheet.chains.size() << " chain files, "
+        << sheet.w << " x " << sheet.h << " mm, loaded in " << std::fixed << std::setprecision(0) << ms(t0) << " ms\n";
+
+    // pack inside the margins
+    t0 = Clock::now();
+    std::vector<double> radius;
+    for (const Figure& f : sheet.figures) radius.push_back(f.reachPx * sheet.scale);
+    std::vector<Vec2d> centres;
+    std::vector<bool> placed;
+    const std::size_t fit = packCircles(radius, sheet.w - 2.0 * sheet.margin, sheet.h - 2.0 * sheet.margin,
+        sheet.gap, centres, placed);
+    double area = 0.0;
+    for (std::size_t i = 0; i < sheet.figures.size(); ++i) {
+        Figure& f = sheet.figures[i];
+        f.placed = placed[i];
+        f.centre = centres[i] + Vec2d{ sheet.margin, sheet.margin };
+        if (f.placed) area += 3.141592653589793 * radius[i] * radius[i];
+    }
+    std::cout << "packed " << fit << " in " << ms(t0) << " ms, circles cover " << std::setprecision(1)
+        << 100.0 * area / (sheet.w * sheet.h) << "% of the page";
+    if (fit < sheet.figures.size()) std::cout << "; " << sheet.figures.size() - fit << " did not fit";
+    std::cout << "\n";
+
+    // one pass per pen, each tour from where the last ended
+    t0 = Clock::now();
+    std::vector<std::vector<std::size_t>> passes(kMaxPen + 1);
+    for (std::size_t i = 0; i < sheet.figures.size(); ++i)
+        if (sheet.figures[i].placed) passes[sheet.figures[i].pen].push_back(i);
+    double listTravel = 0.0, planTravel = 0.0;   // between centres, mm
+    Vec2d home{}, listAt = home, planAt = home;
+    for (auto& pass : passes) {
+        if (pass.empty()) continue;
+        std::vector<Vec2d> points;
+        for (const std::size_t i : pass) {
+            points.push_back(sheet.figures[i].centre);
+            listTravel += dist(listAt, points.back());
+            listAt = points.back();
+        }
+        const std::vector<std::size_t> tour = planTour(points, planAt);
+        std::vector<std::size_t> ordered;
+        for (const std::size_t k : tour) {
+            ordered.push_back(pass[k]);
+            planTravel += dist(planAt, points[k]);
+            planAt = points[k];
+        }
+        pass = std::move(ordered);
+    }
+    std::cout << "planned in " << std::setprecision(0) << ms(t0) << " ms: " << std::setprecision(2)
+        << planTravel / 1000.0 << " m between figures (" << listTravel / 1000.0 << " m in list order)\n";
+
+    // plot
+    t0 = Clock::now();
+    std::ofstream out(opts.out, std::ios::binary);
+    if (!out) {
+        std::cerr << "cannot write " << opts.out << "\n";
+        return 2;
+    }
+    out << "IN;\n";
+    std::vector<sf::Vector2f> buf;
+    std::vector<sf::Vector2<long>> pts;
+    sf::Vector2<long> pen{ 0, 0 };
+    double penUp = 0.0;   // plotter units
+    std::size_t points = 0;
+    for (int p = 1; p <= kMaxPen; ++p) {
+        if (passes[p].empty()) continue;
+        out << "SP" << p << ";\n";
+        for (const std::size_t i : passes[p]) {
+            const Figure& f = sheet.figures[i];
+            sampleFigure(f, sheet, buf, pts);
+            if (pts.empty()) continue;
+
+            // a closed figure can start anywhere along it: at the point nearest the pen
+            std::size_t first = 0;
+            if (f.closed && pts.size() > 2) {
+                if (pts.back().x == pts.front().x && pts.back().y == pts.front().y) pts.pop_back();
+                auto d2 = [&](sf::Vector2<long> q) { const double dx = double(q.x - pen.x), dy = double(q.y - pen.y); return dx * dx + dy * dy; };
+                for (std::size_t k = 1; k < pts.size(); ++k)
+                    if (d2(pts[k]) < d2(pts[first])) first = k;
+            }
+            const std::size_t count = f.closed && pts.size() > 2 ? pts.size() + 1 : pts.size();   // closed: back to the start
+            auto at = [&](std::size_t k) { return pts[(first + k) % pts.size()]; };
+
+            penUp += std::hypot(double(at(0).x - pen.x), double(at(0).y - pen.y));
+            out << "PU" << at(0).x << ',' << at(0).y << ";\n";
+            for (std::size_t k = 1; k < count; k += kPointsPerPd) {
+                out << "PD";
+                for (std::size_t m = k; m < std::min(count, k + kPointsPerPd); ++m)
+                    out << (m > k ? "," : "") << at(m).x << ',' << at(m).y;
+                out << ";\n";
+            }
+            pen = at(count - 1);
+            points += count;
+        }
+    }
+    out << "PU;\nSP0;\n";
+    out.close();
+    if (!out) {
+        std::cerr << "cannot write " << opts.out << "\n";
+        return 2;
+    }
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(opts.out, ec);
+    std::cout << "plotted " << points << " points in " << std::setprecision(0) << ms(t0) << " ms, "
+        << std::setprecision(2) << penUp / kUnitsPerMm / 1000.0 << " m pen-up -> " << opts.out << " ("
+        << std::setprecision(1) << (ec ? 0.0 : bytes / 1048576.0) << " MB)\n";
+    return fit < sheet.figures.size() ? 1 : 0;
+}
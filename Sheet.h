@@ -0,0 +1,45 @@
+// Sheet.h — many figures on one plotter sheet, written as a single HPGL file
+//
+// --compose FILE reads a sheet file naming chain configs (writeChain's
+// format: the app's chain exports), packs the figures' bounding circles onto
+// the page and plots every figure pen by pen. The bounding circle is
+// analytic, the sum of the chain's |amp| about the base centre, so packing
+// needs no samples. Circles go largest first, each at the lowest (then
+// leftmost) spot where it touches two placed circles or the page edge.
+// Within each pen's pass the figures are visited nearest neighbour first,
+// then the tour is improved with 2-opt; a closed figure starts at its sample
+// nearest the pen, so pen-up travel is short jumps between neighbours.
+//
+// Sheet file, lengths in mm, '#' starts a comment:
+//     page <w> <h>                        default 420 297 (A3 landscape)
+//     margin <m>                          default 10
+//     gap <g>                             between bounding circles, default 2
+//     scale <s>                           mm per logical pixel, default 0.1
+//     step <s>                            longest plotted step, default 0.2
+//     figure <chain file> [pen [copies]]  pen 1..8, default 1; copies default 1
+// Chain file paths are relative to the sheet file.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+struct SheetOptions {
+    std::string sheet;               // empty = off
+    std::string out = "sheet.hpgl";
+};
+
+// Packs circles (radius each, gap between any two) into a w x h rectangle,
+// radii already inside their own margin. centres[i] is set for circles that
+// fit; placed[i] says which did. Returns how many fit.
+std::size_t packCircles(const std::vector<double>& radius, double w, double h, double gap,
+    std::vector<sf::Vector2<double>>& centres, std::vector<bool>& placed);
+
+// Visiting order for points starting from `from`: nearest neighbour, then
+// 2-opt moves until none shortens the path (which is open at the end).
+std::vector<std::size_t> planTour(const std::vector<sf::Vector2<double>>& points, sf::Vector2<double> from);
+
+// Returns the process exit code: 0 = every figure plotted, 1 = some did not
+// fit on the page, 2 = the sheet or a chain file could not be read, or the
+// plot file not written.
+int runSheet(const SheetOptions& opts);
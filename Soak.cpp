@@ -0,0 +1,168 @@
+// Soak.cpp — long-run stability check (see Soak.h)
+
+#include "Soak.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+#include "IndexedCanvas.h"
+#include "TraceRebuild.h"
+#include "Tracer.h"
+#include "Viewports.h"
+
+namespace {
+
+constexpr float    kFrameDt = 1.f / 120.f;        // what the app adds to t per frame
+constexpr double   kMaxPenErrPx = 0.5;            // live pen vs reference
+constexpr double   kMaxGrowthBytes = 8.0 * 1024 * 1024;   // second half of the run
+
+// Resident set size in bytes (0 where unknown).
+std::size_t residentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc)) return pmc.WorkingSetSize;
+    return 0;
+#elif defined(__linux__)
+    std::FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long size = 0, resident = 0;
+    const int n = std::fscanf(f, "%lu %lu", &size, &resident);
+    std::fclose(f);
+    return n == 2 ? static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+// The compiled chain carried out in long double.
+void referencePen(const CompiledChain& c, long double t, long double& x, long double& y) {
+    x = 0.0L; y = 0.0L;
+    for (const auto& term : c.terms) {
+        const long double a = static_cast<long double>(term.omega) * t + term.phase;
+        x += term.amp * std::cos(a);
+        y += term.amp * std::sin(a);
+    }
+}
+
+double penError(sf::Vector2f p, long double rx, long double ry) {
+    return std::hypot(static_cast<double>(p.x - rx), static_cast<double>(p.y - ry));
+}
+
+// Distance between two hue-cycle positions, in degrees (0..180).
+double hueError(double lenA, double lenB, double pixelsPerCycle) {
+    double d = std::fmod(std::fabs(lenA - lenB) / pixelsPerCycle, 1.0);
+    return std::min(d, 1.0 - d) * 360.0;
+}
+
+double percentile(std::vector<float>& v, double p) {
+    if (v.empty()) return 0.0;
+    const std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+} // namespace
+
+int runSoak(const SoakOptions& opts) {
+    std::ofstream csv(opts.csvPath);
+    if (!csv) { std::cerr << "soak: cannot write " << opts.csvPath << "\n"; return 1; }
+    csv << "sim_s,wall_s,frames,rss_bytes,frame_ms_p50,frame_ms_p95,frame_ms_p99,frame_ms_max,"
+           "t_err_s,t_float_err_s,path_len,path_len_float,hue_float_err_deg,pen_err_px,pen_float_err_px\n";
+
+    const float R = 200.f;
+    const std::vector<Stage> chain = defaultChain(R);
+    const sf::Vector2f center{ kLogicalW * 0.5f, kLogicalH * 0.5f };
+
+    IndexedCanvas canvas;
+    canvas.resize({ kLogicalW, kLogicalH }, center, 1.f);
+    Tracer tracer;
+    FrameSamples frame;
+    std::vector<TraceRun> runs{ TraceRun{ compileChain(R, chain), 0.0, 0.0, 0.0 } };
+    tracer.compiled = &runs.back().chain;
+
+    // app state (double) and the float state it replaced, advanced alike
+    const long warp = std::max(1L, opts.warp);
+    long long appFrames = 0;
+    double t = 0.0;
+    float tFloat = 0.f;
+    float pathLenFloat = 0.f;
+
+    std::vector<float> frameMs;
+    double maxPenErr = 0.0;
+    std::size_t rssFirstHalf = 0, rssLast = 0;
+    double nextRow = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+
+    std::cout << "soak: " << opts.seconds << " s simulated, " << warp << " frames per step, row every "
+        << opts.every << " s -> " << opts.csvPath << "\n";
+    for (;;) {
+        const long double tRef = static_cast<long double>(appFrames) * kFrameDt;
+        if (static_cast<double>(tRef) >= nextRow || static_cast<double>(tRef) >= opts.seconds) {
+            long double rx, ry;
+            referencePen(runs.back().chain, tRef, rx, ry);
+            const double penErr = penError(penAtTime(R, chain, t), rx, ry);
+            const double penFloatErr = penError(penAtTime(R, chain, tFloat), rx, ry);
+            maxPenErr = std::max(maxPenErr, penErr);
+            const std::size_t rss = residentBytes();
+            if (tRef * 2 <= opts.seconds) rssFirstHalf = std::max(rssFirstHalf, rss);
+            rssLast = rss;
+
+            csv << std::setprecision(10) << static_cast<double>(tRef) << ","
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << ","
+                << appFrames << "," << rss << ","
+                << std::setprecision(4) << percentile(frameMs, 0.5) << "," << percentile(frameMs, 0.95) << ","
+                << percentile(frameMs, 0.99) << ","
+                << (frameMs.empty() ? 0.f : *std::max_element(frameMs.begin(), frameMs.end())) << ","
+                << std::setprecision(6) << static_cast<double>(std::fabs(t - tRef)) << ","
+                << static_cast<double>(std::fabs(tFloat - tRef)) << ","
+                << std::setprecision(12) << tracer.pathLen << "," << pathLenFloat << ","
+                << std::setprecision(6) << hueError(tracer.pathLen, pathLenFloat, tracer.pixelsPerCycle) << ","
+                << penErr << "," << penFloatErr << "\n";
+            csv.flush();
+            frameMs.clear();
+            nextRow += opts.every;
+            if (static_cast<double>(tRef) >= opts.seconds) break;
+        }
+
+        // one soak frame: the clocks take warp frame steps, the tracer one advance
+        const auto f0 = std::chrono::steady_clock::now();
+        for (long k = 0; k < warp; ++k) { t += kFrameDt; tFloat += kFrameDt; }
+        appFrames += warp;
+
+        frame.clearSegments();
+        nestedPenAndCenters_perStageSpeed(R, chain, t, &frame.centers);
+        runs.back().t1 = t;
+        tracer.advance(canvas, R, chain, center, t, canvas.scale(),
+            [&](double, sf::Vector2f p0, sf::Vector2f p1, sf::Color c0, sf::Color c1) {
+                pathLenFloat += std::hypot(p1.x - p0.x, p1.y - p0.y);
+                frame.segments.push_back({ p0, p1, c0, c1 });
+                });
+        frameMs.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - f0).count());
+    }
+
+    const double growth = static_cast<double>(rssLast) - static_cast<double>(rssFirstHalf);
+    const bool leak = rssFirstHalf > 0 && growth > kMaxGrowthBytes;
+    const bool drift = !(maxPenErr <= kMaxPenErrPx);
+    std::cout << std::fixed << std::setprecision(3)
+        << "soak: rss " << rssFirstHalf / 1048576.0 << " MiB at half time, " << rssLast / 1048576.0 << " MiB at the end"
+        << (leak ? "  GROWING" : "  ok") << "\n"
+        << "soak: max live pen error " << std::scientific << maxPenErr << " px" << (drift ? "  FAIL" : "  ok")
+        << "; float state at the end: t off by " << static_cast<double>(std::fabs(tFloat - t)) << " s, pathLen off by "
+        << std::fabs(tracer.pathLen - pathLenFloat) << " px\n";
+    return (leak || drift) ? 6 : 0;
+}
@@ -0,0 +1,25 @@
+// Soak.h — long-run stability check: days of simulated time, compressed
+//
+// --soak SECONDS runs the live trace headless (Tracer into an IndexedCanvas,
+// the per-frame sample buffer, the open history run) until SECONDS of
+// simulated time have passed. Each soak frame stands for --soak-warp app
+// frames at 120 Hz: the clocks get that many frame steps, the tracer one
+// advance over the whole span. Every --soak-every simulated seconds a CSV row
+// records resident memory, frame-time percentiles since the previous row, and
+// how far the float state the app used to keep (t summed per frame, pathLen
+// summed per segment) has drifted from the double state, with the pen and
+// hue error that costs against a long-double reference.
+#pragma once
+
+#include <string>
+
+struct SoakOptions {
+    double      seconds = 0.0;        // simulated seconds to run
+    long        warp = 60;            // app frames per soak frame
+    double      every = 3600.0;       // simulated seconds between CSV rows
+    std::string csvPath = "soak.csv";
+};
+
+// Returns the process exit code: 0 = stable, 6 = resident memory kept growing
+// through the second half or the live pen drifted over kMaxPenErrPx.
+int runSoak(const SoakOptions& opts);
@@ -0,0 +1,175 @@
+// Spiro3D.cpp — spherical 3-D mode (see Spiro3D.h)
+
+#include "Spiro3D.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double reachOf(const CompiledChain& c) {
+    double r = 0.0;
+    for (const auto& term : c.terms) r += std::fabs(term.amp);
+    return r > 0.0 ? r : 1.0;
+}
+
+// One LSD pass on 8 bits of key: src -> dst, stable.
+void radixPass(const std::vector<std::uint32_t>& src, const std::vector<std::uint16_t>& keySrc,
+    std::vector<std::uint32_t>& dst, std::vector<std::uint16_t>& keyDst, int shift)
+{
+    std::size_t count[257] = {};
+    for (std::size_t i = 0; i < src.size(); ++i) ++count[((keySrc[i] >> shift) & 0xFF) + 1];
+    for (int b = 0; b < 256; ++b) count[b + 1] += count[b];
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        const std::size_t at = count[(keySrc[i] >> shift) & 0xFF]++;
+        dst[at] = src[i];
+        keyDst[at] = keySrc[i];
+    }
+}
+
+} // namespace
+
+Spiro3D::Spiro3D(std::size_t capacity)
+    : pts_(std::max<std::size_t>(capacity, 2)), hue_(pts_.size()), joined_(pts_.size())
+{
+}
+
+void Spiro3D::clear() {
+    head_ = count_ = 0;
+    haveLast_ = false;
+    pathLen_ = 0.0;
+}
+
+void Spiro3D::push(const sf::Vector3f& p, double pathLen, bool joined) {
+    pts_[head_] = p;
+    hue_[head_] = pathHueIndex(pathLen, pixelsPerCycle, hueOffset);
+    joined_[head_] = joined ? 1 : 0;
+    head_ = (head_ + 1) % pts_.size();
+    count_ = std::min(count_ + 1, pts_.size());
+}
+
+sf::Vector3f Spiro3D::lift(sf::Vector2f p, double reach) const {
+    const float r = std::hypot(p.x, p.y);
+    const float theta = static_cast<float>(r / reach) * wrapAngle;
+    const float cp = r > 1e-6f ? p.x / r : 1.f, sp = r > 1e-6f ? p.y / r : 0.f;
+    const float st = std::sin(theta) * sphereRadius;
+    // the pole (chain centre) faces the camera, which looks down +z
+    return { st * cp, st * sp, -std::cos(theta) * sphereRadius };
+}
+
+Spiro3D::Rotation Spiro3D::rotationAt(double t) const {
+    const float cy = static_cast<float>(std::cos(spin * t)), sy = static_cast<float>(std::sin(spin * t));
+    const float cx = std::cos(tilt), sx = std::sin(tilt);
+    // Rx(tilt) * Ry(spin t)
+    return { { { cy, 0.f, sy },
+               { sx * sy, cx, -sx * cy },
+               { -cx * sy, sx, cx * cy } } };
+}
+
+int Spiro3D::trace(const CompiledChain& c, double t) {
+    const double reach = reachOf(c);
+    if (!haveLast_) {
+        lastPlanar_ = evalPen(c, t);
+        push(lift(lastPlanar_, reach), pathLen_, false);
+        haveLast_ = true;
+        lastT_ = t;
+        return 1;
+    }
+    if (t <= lastT_) return 0;
+
+    // planar distance -> sphere arc length (exact at the pole, shorter elsewhere)
+    const float k = static_cast<float>(sphereRadius * wrapAngle / reach);
+    const sf::Vector2f end = evalPen(c, t);
+    int steps = static_cast<int>(std::ceil(std::hypot(end.x - lastPlanar_.x, end.y - lastPlanar_.y) * k
+        / std::max(0.1f, maxPixelStep)));
+    steps = std::clamp(steps, 1, maxSubsteps);
+
+    const double h = (t - lastT_) / steps;
+    planar_.resize(static_cast<std::size_t>(steps));
+    evalPenBatch(c, lastT_ + h, h, planar_.size(), planar_.data());
+
+    sf::Vector2f prev = lastPlanar_;
+    for (const sf::Vector2f& q : planar_) {
+        pathLen_ += std::hypot(q.x - prev.x, q.y - prev.y) * k;
+        push(lift(q, reach), pathLen_, true);
+        prev = q;
+    }
+    lastPlanar_ = prev;
+    lastT_ = t;
+    return steps;
+}
+
+sf::Vector2f Spiro3D::project(const CompiledChain& c, sf::Vector2f p, sf::Vector2f center, double t) const {
+    const Rotation R = rotationAt(t);
+    const sf::Vector3f v = lift(p, reachOf(c));
+    const float D = cameraDistance * sphereRadius;
+    const float x = R.m[0][0] * v.x + R.m[0][1] * v.y + R.m[0][2] * v.z;
+    const float y = R.m[1][0] * v.x + R.m[1][1] * v.y + R.m[1][2] * v.z;
+    const float z = R.m[2][0] * v.x + R.m[2][1] * v.y + R.m[2][2] * v.z;
+    const float s = D / (D + z);
+    return { center.x + x * s, center.y + y * s };
+}
+
+void Spiro3D::build(sf::Vector2f center, double t, std::vector<sf::Vertex>& out) {
+    const std::size_t n = count_, cap = pts_.size();
+    if (n < 2) { out.clear(); return; }
+    const std::size_t first = (head_ + cap - n) % cap;   // oldest point
+
+    // rotate + project every point once
+    const Rotation R = rotationAt(t);
+    const float D = cameraDistance * sphereRadius;
+    const float invDepth = 0.5f / sphereRadius;
+    proj_.resize(n);
+    for (std::size_t i = 0, j = first; i < n; ++i, j = (j + 1 == cap ? 0 : j + 1)) {
+        const sf::Vector3f& v = pts_[j];
+        const float x = R.m[0][0] * v.x + R.m[0][1] * v.y + R.m[0][2] * v.z;
+        const float y = R.m[1][0] * v.x + R.m[1][1] * v.y + R.m[1][2] * v.z;
+        const float z = R.m[2][0] * v.x + R.m[2][1] * v.y + R.m[2][2] * v.z;
+        const float s = D / (D + z);
+        proj_[i] = { { center.x + x * s, center.y + y * s }, s, std::clamp(z * invDepth + 0.5f, 0.f, 1.f) };
+    }
+
+    // joined segments keyed far-to-near (ascending key = descending depth)
+    order_.clear();
+    key_.clear();
+    for (std::size_t i = 1; i < n; ++i) {
+        if (!joined_[(first + i) % cap]) continue;
+        const float d = 0.5f * (proj_[i - 1].depth + proj_[i].depth);
+        order_.push_back(static_cast<std::uint32_t>(i));
+        key_.push_back(static_cast<std::uint16_t>((1.f - d) * 65535.f));
+    }
+    tmp_.resize(order_.size());
+    keyTmp_.resize(key_.size());
+    radixPass(order_, key_, tmp_, keyTmp_, 0);
+    radixPass(tmp_, keyTmp_, order_, key_, 8);
+
+    // one quad per segment, back to front
+    const auto& pal = pathPalette();
+    if (out.size() < order_.size() * 6) out.resize(order_.size() * 6);   // only the growth gets initialised
+    sf::Vertex* w = out.data();
+    for (const std::uint32_t i : order_) {
+        const Projected& a = proj_[i - 1];
+        const Projected& b = proj_[i];
+        const sf::Vector2f d = b.p - a.p;
+        const float len = std::sqrt(d.x * d.x + d.y * d.y);   // not hypot: this loop is the hot one
+        if (len < 1e-4f) continue;
+        const sf::Vector2f nrm{ -d.y / len, d.x / len };
+
+        auto shade = [&](const Projected& p, std::uint8_t hue) {
+            sf::Color c = pal[hue];
+            const float k = 1.f - 0.65f * p.depth;   // far side darker and fainter
+            c.r = static_cast<std::uint8_t>(c.r * k);
+            c.g = static_cast<std::uint8_t>(c.g * k);
+            c.b = static_cast<std::uint8_t>(c.b * k);
+            c.a = static_cast<std::uint8_t>(c.a * (1.f - 0.45f * p.depth));
+            return c;
+            };
+        const sf::Color ca = shade(a, hue_[(first + i - 1) % cap]);
+        const sf::Color cb = shade(b, hue_[(first + i) % cap]);
+        const sf::Vector2f na = nrm * (stroke * 0.5f * a.scale), nb = nrm * (stroke * 0.5f * b.scale);
+        w[0] = { a.p - na, ca }; w[1] = { a.p + na, ca }; w[2] = { b.p + nb, cb };
+        w[3] = w[0];             w[4] = w[2];             w[5] = { b.p - nb, cb };
+        w += 6;
+    }
+    out.resize(static_cast<std::size_t>(w - out.data()));
+}
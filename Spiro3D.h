@@ -0,0 +1,70 @@
+// Spiro3D.h — spherical 3-D mode: the pen path wrapped onto a turning sphere
+//
+// Pen samples come from the batch evaluator and are lifted onto a sphere
+// (azimuthal-equidistant: distance from the chain centre becomes polar angle),
+// so the figure reads as rolled on a ball. The sphere turns over time, so the
+// trace cannot live on a 2-D canvas: the last `capacity` points are kept in a
+// ring and every frame all segments are rotated, projected with perspective,
+// radix-sorted back to front by depth and emitted into one triangle batch
+// (painter's algorithm, one draw call). Far segments are darker and thinner.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Spirograph.h"
+
+class Spiro3D {
+public:
+    float sphereRadius = 300.f;     // logical px
+    float wrapAngle = 2.6f;         // polar angle (rad) at the chain's full reach
+    float cameraDistance = 3.f;     // in sphere radii, from the sphere centre
+    float spin = 0.35f;             // rad/s about the tilted vertical axis
+    float tilt = 0.45f;             // rad, towards the viewer
+    float stroke = 2.f;             // logical px at the sphere centre's depth
+    float maxPixelStep = 1.f;       // logical px between samples
+    int   maxSubsteps = 256;
+    float pixelsPerCycle = 600.f;
+    float hueOffset = 0.f;
+
+    explicit Spiro3D(std::size_t capacity = std::size_t(1) << 17);
+
+    void clear();
+    void stop() { haveLast_ = false; }   // next trace() starts a new, unconnected run
+
+    // Samples the pen over (lastT, t] and appends the points. Returns the samples added.
+    int trace(const CompiledChain& c, double t);
+
+    // Rotated to time t, projected around `center`, sorted, into out (Triangles).
+    void build(sf::Vector2f center, double t, std::vector<sf::Vertex>& out);
+
+    // Where the pen at local position p lands on screen at time t.
+    sf::Vector2f project(const CompiledChain& c, sf::Vector2f p, sf::Vector2f center, double t) const;
+
+    std::size_t segments() const { return count_ > 0 ? count_ - 1 : 0; }
+    std::size_t capacity() const { return pts_.size(); }
+
+private:
+    struct Rotation { float m[3][3]; };
+    Rotation rotationAt(double t) const;
+    sf::Vector3f lift(sf::Vector2f p, double reach) const;
+    void push(const sf::Vector3f& p, double pathLen, bool joined);
+
+    // ring of points; joined_: connected to the previous point
+    std::vector<sf::Vector3f> pts_;
+    std::vector<std::uint8_t> hue_, joined_;
+    std::size_t head_ = 0, count_ = 0;
+
+    bool haveLast_ = false;
+    double lastT_ = 0.0;
+    sf::Vector2f lastPlanar_{};
+    double pathLen_ = 0.0;
+
+    // per-frame scratch (capacity kept)
+    std::vector<sf::Vector2f> planar_;
+    struct Projected { sf::Vector2f p; float scale, depth; };   // depth 0 = nearest, 1 = farthest
+    std::vector<Projected> proj_;
+    std::vector<std::uint32_t> order_, tmp_;
+    std::vector<std::uint16_t> key_, keyTmp_;
+};
@@ -0,0 +1,410 @@
+// Spirograph.cpp — chain model and evaluator
+
+#include "Spirograph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+// ---------- colour ----------
+sf::Color hsv(float h, float s, float v, std::uint8_t a) {
+    float c = v * s;
+    float x = c * (1.f - std::fabs(std::fmod(h / 60.f, 2.f) - 1.f));
+    float m = v - c;
+    float r = 0, g = 0, b = 0;
+    if (h < 60) { r = c; g = x; b = 0; }
+    else if (h < 120) { r = x; g = c; b = 0; }
+    else if (h < 180) { r = 0; g = c; b = x; }
+    else if (h < 240) { r = 0; g = x; b = c; }
+    else if (h < 300) { r = x; g = 0; b = c; }
+    else { r = c; g = 0; b = x; }
+    auto to8 = [](float u) { return static_cast<std::uint8_t>(std::round(u * 255.f)); };
+    return sf::Color(to8(r + m), to8(g + m), to8(b + m), a);
+}
+
+// Position in the hue cycle, [0, 360) for a non-negative offset. The whole
+// cycles are dropped in double before the float arithmetic.
+static float pathHue(double pathLen, float pixelsPerCycle, float hueOffset) {
+    const float cycle = static_cast<float>(std::fmod(pathLen / pixelsPerCycle, 1.0));
+    return std::fmod(cycle * 360.f + hueOffset, 360.f);
+}
+
+sf::Color pathColor(double pathLen, float pixelsPerCycle, float hueOffset) {
+    return hsv(pathHue(pathLen, pixelsPerCycle, hueOffset), 1.f, 1.f);
+}
+
+std::uint8_t pathHueIndex(double pathLen, float pixelsPerCycle, float hueOffset) {
+    const float h = pathHue(pathLen, pixelsPerCycle, hueOffset);
+    return static_cast<std::uint8_t>(static_cast<int>(std::floor(h * (256.f / 360.f))) & 255);
+}
+
+const std::array<sf::Color, 256>& pathPalette() {
+    static const std::array<sf::Color, 256> lut = [] {
+        std::array<sf::Color, 256> p;
+        for (int i = 0; i < 256; ++i) p[i] = hsv(i * (360.f / 256.f), 1.f, 1.f);
+        return p;
+    }();
+    return lut;
+}
+
+// ---------- model ----------
+std::vector<Stage> defaultChain(float R) {
+    // Stages (distinct speeds; negative reverses) — cleaner speeds + level=1..N
+    std::vector<Stage> chain;
+    float radius = R;
+    const float radiusDiv = 3.f;
+    const float baseSpeed = -4.00f; // rad/s
+    const int   count = 10;
+
+    for (int i = 0; i < count; ++i) {
+        radius /= radiusDiv;
+        float s = std::pow(baseSpeed, static_cast<float>(i));
+        chain.emplace_back(/*level*/ i + 1,
+            /*r*/ radius,
+            /*d*/ 0.f,               // set last stage's d below
+            /*outside*/ true,
+            /*speed*/ s);
+    }
+    if (!chain.empty()) {
+        // Give the last stage a real pen offset so we trace something non-trivial
+        chain.back().d = chain.back().r * 0.75f;
+    }
+    return chain;
+}
+
+// ---------- evaluator ----------
+// Nested centers + pen with per-stage speeds.
+// Returns local coords (add screen center to draw).
+sf::Vector2f nestedPenAndCenters_perStageSpeed(float R,
+    const std::vector<Stage>& stages,
+    double t,
+    std::vector<sf::Vector2f>* outCenters)
+{
+    if (outCenters) outCenters->clear();
+    sf::Vector2f acc{ 0.f, 0.f };
+    float baseRadius = R;
+
+    for (std::size_t j = 0; j < stages.size(); ++j) {
+        const Stage& s = stages[j];
+        double alpha = s.speed * t + s.phase;
+        // kappa in double for the pen term's frequency, as compileChain
+        double kappa = s.outside ? (static_cast<double>(baseRadius) + s.r) : (static_cast<double>(baseRadius) - s.r);
+
+        acc.x += static_cast<float>(kappa * std::cos(alpha));
+        acc.y += static_cast<float>(kappa * std::sin(alpha));
+        if (outCenters) outCenters->push_back(acc);
+
+        bool last = (j + 1 == stages.size());
+        if (last) {
+            double freq = kappa / s.r;
+            double beta = freq * alpha;
+            float ox, oy;
+            const float cb = static_cast<float>(std::cos(beta)), sb = static_cast<float>(std::sin(beta));
+            if (s.outside) { ox = -s.d * cb; oy = -s.d * sb; }
+            else { ox = s.d * cb; oy = -s.d * sb; }
+            acc.x += ox; acc.y += oy;
+        }
+        else {
+            baseRadius = s.r; // next stage rolls on this disc
+        }
+    }
+    return acc;
+}
+
+// ---------- compiled chain ----------
+CompiledChain compileChain(float R, const std::vector<Stage>& chain) {
+    CompiledChain c;
+    c.terms.reserve(chain.size() + 1);
+    double baseRadius = R;
+    for (std::size_t j = 0; j < chain.size(); ++j) {
+        const Stage& s = chain[j];
+        // kappa in double: rounding it to float shifts the pen term's
+        // frequency (kappa / r), which grows without bound with t
+        const double kappa = s.outside ? (baseRadius + s.r) : (baseRadius - s.r);
+        c.terms.push_back({ kappa, s.speed, s.phase });
+        if (j + 1 == chain.size()) {
+            // outside: -d * e^{i beta};  inside: d * e^{-i beta}
+            const double freq = kappa / s.r;
+            if (s.outside) c.terms.push_back({ -s.d, freq * s.speed, freq * s.phase });
+            else           c.terms.push_back({ s.d, -freq * s.speed, -freq * s.phase });
+        }
+        baseRadius = s.r;
+    }
+    return c;
+}
+
+sf::Vector2f evalPen(const CompiledChain& c, double t) {
+    double x = 0.0, y = 0.0;
+    for (const auto& term : c.terms) {
+        const double a = term.omega * t + term.phase;
+        x += term.amp * std::cos(a);
+        y += term.amp * std::sin(a);
+    }
+    return { static_cast<float>(x), static_cast<float>(y) };
+}
+
+namespace {
+
+constexpr double kRampSteps = 256.0 * 2.0 / 3.0;   // Speed / Curvature: red .. blue
+
+// m samples at t0 + k*dt; v* / a* are the batch's derivative accumulators,
+// still in double (unused for Time and Phase). The mode is switched on once
+// per block, and the ramps are ratios of squared quantities, so a sample
+// costs a few multiplies and one division: no square root, trig or fmod.
+void motionHues(const ColorParams& p, float hueOffset, double t0, double dt, std::size_t m,
+    const double* vx, const double* vy, const double* ax, const double* ay,
+    const CompiledChain::Term* dominant, std::uint8_t* out)
+{
+    const double base = std::floor(hueOffset * (256.0 / 360.0));
+    auto put = [&](std::size_t k, double steps) {
+        out[k] = static_cast<std::uint8_t>(static_cast<int>(std::floor(base + steps)) & 255);
+    };
+    switch (p.by) {
+    case ColorBy::Speed: {
+        // s^2 / (s^2 + ref^2): halfway at speedRef
+        const double ref2 = static_cast<double>(p.speedRef) * p.speedRef;
+        for (std::size_t k = 0; k < m; ++k) {
+            const double s2 = vx[k] * vx[k] + vy[k] * vy[k];
+            put(k, kRampSteps * s2 / (s2 + ref2));
+        }
+        break;
+    }
+    case ColorBy::Curvature: {
+        // x^2 / (1 + x^2) for x = curvature * ref = |v x a| ref / s^3: halfway at curvatureRef
+        for (std::size_t k = 0; k < m; ++k) {
+            const double s2 = vx[k] * vx[k] + vy[k] * vy[k];
+            const double c = (vx[k] * ay[k] - vy[k] * ax[k]) * p.curvatureRef;
+            const double c2 = c * c, s6 = s2 * s2 * s2;
+            put(k, c2 + s6 > 0.0 ? kRampSteps * c2 / (c2 + s6) : 0.0);
+        }
+        break;
+    }
+    case ColorBy::Time: {
+        const double rate = 256.0 / std::max(1e-3f, p.timeCycle);   // steps per second
+        const double s0 = std::fmod(t0 * rate, 256.0);
+        for (std::size_t k = 0; k < m; ++k) put(k, s0 + rate * dt * static_cast<double>(k));
+        break;
+    }
+    case ColorBy::Phase: {
+        if (!dominant) { for (std::size_t k = 0; k < m; ++k) put(k, 0.0); break; }
+        const double rate = dominant->omega * (256.0 / 6.283185307179586);
+        const double s0 = std::fmod(t0 * rate + dominant->phase * (256.0 / 6.283185307179586), 256.0);
+        for (std::size_t k = 0; k < m; ++k) put(k, s0 + rate * dt * static_cast<double>(k));
+        break;
+    }
+    case ColorBy::Winding:
+        for (std::size_t k = 0; k < m; ++k) put(k, vx[k] * ay[k] - vy[k] * ax[k] < 0.0 ? 128.0 : 0.0);
+        break;
+    default:
+        for (std::size_t k = 0; k < m; ++k) put(k, 0.0);
+        break;
+    }
+}
+
+// Highest derivative a mode reads: Speed needs only the velocity.
+int derivOrder(ColorBy by) {
+    switch (by) {
+    case ColorBy::Speed:     return 1;
+    case ColorBy::Curvature:
+    case ColorBy::Winding:   return 2;
+    default:                 return 0;
+    }
+}
+
+struct HueOut {
+    std::uint8_t* out;
+    const ColorParams* params;
+    float hueOffset;
+    const CompiledChain::Term* dominant;
+};
+
+// Order = how many derivatives to accumulate; 0 compiles to the plain
+// position loop. vel / acc may be null when only hue wants them.
+template <int Order>
+void evalPenBatchImpl(const CompiledChain& c, double t0, double dt, std::size_t n,
+    sf::Vector2f* out, sf::Vector2f* vel, sf::Vector2f* acc, const HueOut* hue = nullptr)
+{
+    constexpr std::size_t kReseed = 256;
+    double xs[kReseed], ys[kReseed];
+    double vx[Order >= 1 ? kReseed : 1], vy[Order >= 1 ? kReseed : 1];
+    double ax[Order >= 2 ? kReseed : 1], ay[Order >= 2 ? kReseed : 1];
+
+    for (std::size_t base = 0; base < n; base += kReseed) {
+        const std::size_t m = std::min(kReseed, n - base);
+        std::fill(xs, xs + m, 0.0);
+        std::fill(ys, ys + m, 0.0);
+        if constexpr (Order >= 1) { std::fill(vx, vx + m, 0.0); std::fill(vy, vy + m, 0.0); }
+        if constexpr (Order >= 2) { std::fill(ax, ax + m, 0.0); std::fill(ay, ay + m, 0.0); }
+        const double tb = t0 + dt * static_cast<double>(base);
+
+        for (const auto& term : c.terms) {
+            const double a = term.omega * tb + term.phase;
+            double zr = term.amp * std::cos(a), zi = term.amp * std::sin(a);
+            const double rr = std::cos(term.omega * dt), ri = std::sin(term.omega * dt);
+            const double w = term.omega, w2 = term.omega * term.omega;
+            for (std::size_t k = 0; k < m; ++k) {
+                xs[k] += zr; ys[k] += zi;
+                // d/dt of amp e^{i(wt+phase)} is i w z, and the second derivative is -w^2 z
+                if constexpr (Order >= 1) { vx[k] -= w * zi; vy[k] += w * zr; }
+                if constexpr (Order >= 2) { ax[k] -= w2 * zr; ay[k] -= w2 * zi; }
+                const double nr = zr * rr - zi * ri;
+                zi = zr * ri + zi * rr;
+                zr = nr;
+            }
+        }
+        for (std::size_t k = 0; k < m; ++k) {
+            out[base + k] = { static_cast<float>(xs[k]), static_cast<float>(ys[k]) };
+            if constexpr (Order >= 2) {
+                if (vel) {
+                    vel[base + k] = { static_cast<float>(vx[k]), static_cast<float>(vy[k]) };
+                    acc[base + k] = { static_cast<float>(ax[k]), static_cast<float>(ay[k]) };
+                }
+            }
+        }
+        if (hue) motionHues(*hue->params, hue->hueOffset, tb, dt, m, vx, vy, ax, ay, hue->dominant, hue->out + base);
+    }
+}
+
+} // namespace
+
+void evalPenBatch(const CompiledChain& c, double t0, double dt, std::size_t n, sf::Vector2f* out) {
+    evalPenBatchImpl<0>(c, t0, dt, n, out, nullptr, nullptr);
+}
+
+void evalPenBatch(const CompiledChain& c, double t0, double dt, std::size_t n,
+    sf::Vector2f* out, sf::Vector2f* vel, sf::Vector2f* acc)
+{
+    evalPenBatchImpl<2>(c, t0, dt, n, out, vel, acc);
+}
+
+void evalPenBatch(const CompiledChain& c, double t0, double dt, std::size_t n,
+    sf::Vector2f* out, std::uint8_t* hue, const ColorParams& p, float hueOffset)
+{
+    const HueOut h{ hue, &p, hueOffset, p.by == ColorBy::Phase ? dominantTerm(c) : nullptr };
+    switch (derivOrder(p.by)) {
+    case 2:  evalPenBatchImpl<2>(c, t0, dt, n, out, nullptr, nullptr, &h); break;
+    case 1:  evalPenBatchImpl<1>(c, t0, dt, n, out, nullptr, nullptr, &h); break;
+    default: evalPenBatchImpl<0>(c, t0, dt, n, out, nullptr, nullptr, &h); break;
+    }
+}
+
+const char* colorByName(ColorBy m) {
+    switch (m) {
+    case ColorBy::Speed:     return "speed";
+    case ColorBy::Curvature: return "curvature";
+    case ColorBy::Time:      return "time";
+    case ColorBy::Phase:     return "phase";
+    case ColorBy::Winding:   return "winding";
+    default:                 return "path";
+    }
+}
+
+const CompiledChain::Term* dominantTerm(const CompiledChain& c) {
+    const CompiledChain::Term* best = nullptr;
+    for (const auto& term : c.terms)
+        if (!best || std::fabs(term.amp * term.omega) > std::fabs(best->amp * best->omega)) best = &term;
+    return best;
+}
+
+std::uint8_t motionHueIndex(const ColorParams& p, float hueOffset, double t,
+    sf::Vector2f vel, sf::Vector2f acc, const CompiledChain::Term* dominant)
+{
+    const double vx = vel.x, vy = vel.y, ax = acc.x, ay = acc.y;
+    std::uint8_t out;
+    motionHues(p, hueOffset, t, 0.0, 1, &vx, &vy, &ax, &ay, dominant, &out);
+    return out;
+}
+
+void splitBand(const CompiledChain& c, double dt, double maxPhaseStep, double minAmp, BandSplit& out) {
+    out.slow.terms.clear();
+    out.fastTerms = 0;
+    out.radius = out.arcRate = out.slowMaxOmega = 0.0;
+    for (const auto& term : c.terms) {
+        const double w = std::fabs(term.omega);
+        if (w * dt > maxPhaseStep) {
+            ++out.fastTerms;
+            out.radius += std::fabs(term.amp);
+            out.arcRate += std::fabs(term.amp) * w;
+        }
+        else {
+            out.slow.terms.push_back(term);
+            if (std::fabs(term.amp) >= minAmp) out.slowMaxOmega = std::max(out.slowMaxOmega, w);
+        }
+    }
+}
+
+double curvePeriod(const CompiledChain& c, double maxT) {
+    constexpr std::uint64_t kMaxDen = 1000;
+    double wMin = 0.0;
+    for (const auto& term : c.terms) {
+        const double w = std::fabs(term.omega);
+        if (term.amp != 0.0 && w > 0.0 && (wMin == 0.0 || w < wMin)) wMin = w;
+    }
+    if (wMin == 0.0) return maxT;   // nothing moves
+
+    auto gcd = [](std::uint64_t a, std::uint64_t b) { while (b) { const std::uint64_t r = a % b; a = b; b = r; } return a; };
+
+    // every omega as a fraction p/q of the slowest; den = lcm of the q
+    std::uint64_t den = 1;
+    for (const auto& term : c.terms) {
+        if (term.amp == 0.0) continue;
+        const double r = std::fabs(term.omega) / wMin;
+        std::uint64_t q = 1;
+        while (q <= kMaxDen && std::fabs(r * q - std::round(r * q)) > 1e-6 * r * q) ++q;
+        if (q > kMaxDen) return maxT;
+        den = den / gcd(den, q) * q;
+        if (den > kMaxDen * kMaxDen) return maxT;
+    }
+    // ...so each omega is an integer multiple of wMin / den
+    std::uint64_t g = 0;
+    for (const auto& term : c.terms) {
+        if (term.amp == 0.0) continue;
+        g = gcd(static_cast<std::uint64_t>(std::llround(std::fabs(term.omega) / wMin * den)), g);
+    }
+    if (g == 0) return maxT;
+    return std::min(maxT, 6.283185307179586 * den / (wMin * g));
+}
+
+// ---------- config text ----------
+void writeChain(std::ostream& os, float R, const std::vector<Stage>& chain) {
+    os << "# level r d outside speed phase\n";
+    os << std::setprecision(9) << "R " << R << "\n";
+    for (const Stage& s : chain) {
+        os << "stage " << s.level << ' ' << s.r << ' ' << s.d << ' ' << (s.outside ? 1 : 0)
+            << ' ' << s.speed << ' ' << s.phase << "\n";
+    }
+}
+
+bool readChainLine(const std::string& word, std::istream& rest, float& R, std::vector<Stage>& chain, std::string& what) {
+    if (word == "R") {
+        if (!(rest >> R) || R <= 0.f) what = "bad R";
+        return true;
+    }
+    if (word == "stage") {
+        int level, outside; float r, d, speed, phase;
+        if (!(rest >> level >> r >> d >> outside >> speed >> phase)) what = "bad stage";
+        else chain.emplace_back(level, r, d, outside != 0, speed, phase);
+        return true;
+    }
+    return false;
+}
+
+bool readChain(std::istream& in, float& R, std::vector<Stage>& chain, std::string& error) {
+    float fileR = 0.f;
+    std::vector<Stage> fileChain;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        std::istringstream ls(line.substr(0, line.find('#')));
+        std::string word, what;
+        if (!(ls >> word)) continue;
+        if (!readChainLine(word, ls, fileR, fileChain, what)) what = "unknown keyword '" + word + "'";
+        if (!what.empty()) { error = "line " + std::to_string(lineNo) + ": " + what; return false; }
+    }
+    if (fileR <= 0.f || fileChain.empty()) { error = "no R or no stages"; return false; }
+    R = fileR;
+    chain = std::move(fileChain);
+    return true;
+}
@@ -0,0 +1,169 @@
+// Spirograph.h — chain model and evaluator
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// ---------- colour ----------
+sf::Color hsv(float h, float s, float v, std::uint8_t a = 230);
+
+// Rainbow by path length: the hue wraps every pixelsPerCycle pixels. The
+// length is a double so the hue keeps moving after weeks of tracing.
+sf::Color pathColor(double pathLen, float pixelsPerCycle, float hueOffset);
+
+// The same hue cycle quantised to 256 steps, for palette-indexed canvases:
+// pathPalette()[pathHueIndex(...)] ~= pathColor(...).
+std::uint8_t pathHueIndex(double pathLen, float pixelsPerCycle, float hueOffset);
+const std::array<sf::Color, 256>& pathPalette();
+
+// ---------- model ----------
+struct Stage {
+    int   level = 1;     // 1 = first nested disc
+    float r;             // rolling disc radius
+    float d;             // pen offset (used only by the LAST stage)
+    bool  outside;       // false = inside roll; true = outside roll
+    float speed;         // radians/sec (negative = reverse)
+    float phase;         // start angle (radians)
+
+    // (style for last stage trace — kept for future use)
+    float stroke = 6.f;
+    bool  rainbow = true;
+    float pixelsPerCycle = 600.f;
+    float hueOffset = 0.f;
+
+    // visuals
+    sf::CircleShape disc;
+
+    Stage(int lvl, float rr, float dd, bool out, float spd, float ph = -3.14159f / 2.f)
+        : level(lvl), r(rr), d(dd), outside(out), speed(spd), phase(ph), disc(rr)
+    {
+        disc.setOrigin({ r, r });
+        disc.setFillColor(sf::Color::Transparent);
+        disc.setOutlineThickness(2.f);
+        disc.setOutlineColor(sf::Color(140, 200, 255));
+        disc.setPointCount(140);
+    }
+
+    // keep the drawn disc in sync after r changes
+    void syncDisc() { disc.setRadius(r); disc.setOrigin({ r, r }); }
+};
+
+// The start-up chain: 10 outside-rolling stages, each a third the size of the
+// one it rolls on, speeds (-4)^i.
+std::vector<Stage> defaultChain(float R);
+
+// The logical canvas every mode draws the figure in (the window's initial
+// size; exports scale it), and the cap on a full curve whose speeds share no
+// period (curvePeriod's maxT). Shared so the headless modes match the app.
+constexpr unsigned kLogicalW = 1280, kLogicalH = 900;
+constexpr double   kMaxCurveSeconds = 600.0;
+
+// Nested centers + pen with per-stage speeds.
+// Returns local coords (add screen center to draw). Angles and the pen term's
+// frequency are formed in double, so a large t costs no phase and the curve
+// stays the compiled chain's; positions are float.
+sf::Vector2f nestedPenAndCenters_perStageSpeed(float R,
+    const std::vector<Stage>& stages,
+    double t,
+    std::vector<sf::Vector2f>* outCenters);
+
+// Returns the pen *local* position at time t (no centers allocated)
+inline sf::Vector2f penAtTime(float R,
+    const std::vector<Stage>& chain,
+    double t) {
+    return nestedPenAndCenters_perStageSpeed(R, chain, t, nullptr);
+}
+
+// ---------- compiled chain ----------
+// The pen is a sum of rotating vectors: stage j contributes kappa_j * e^{i alpha_j},
+// the last stage's pen offset adds one more term at freq * alpha. Compiling once
+// lets evaluators skip the per-sample inside/outside branching, and gives the
+// per-term angular frequencies directly.
+struct CompiledChain {
+    struct Term {
+        double amp;     // signed length (pixels)
+        double omega;   // rad/s
+        double phase;   // rad at t = 0
+    };
+    std::vector<Term> terms;    // terms[j] = stage j; the pen-offset term is last
+};
+
+CompiledChain compileChain(float R, const std::vector<Stage>& chain);
+
+// Time after which the pen retraces itself: 2*pi over the largest common
+// divisor of the omegas, found by writing each one as a fraction of the
+// slowest (denominator <= 1000, to a part in a million). Returns maxT when
+// they are not that commensurate, or the period is longer.
+double curvePeriod(const CompiledChain& c, double maxT);
+
+// Pen local position at t (double time, exact sin/cos per term).
+sf::Vector2f evalPen(const CompiledChain& c, double t);
+
+// n pen samples at t0 + k*dt written to out[0..n). Each term advances by a
+// fixed complex rotation per sample instead of calling sin/cos; it is re-seeded
+// exactly every few hundred samples so rounding cannot build up.
+void evalPenBatch(const CompiledChain& c, double t0, double dt, std::size_t n, sf::Vector2f* out);
+
+// The same, plus the analytic pen velocity (px/s) and acceleration (px/s^2)
+// at each sample, from the same rotating vectors.
+void evalPenBatch(const CompiledChain& c, double t0, double dt, std::size_t n,
+    sf::Vector2f* out, sf::Vector2f* vel, sf::Vector2f* acc);
+
+// ---------- colour by motion ----------
+// Alternatives to the rainbow by path length, from the analytic derivatives
+// of the rotating vectors (or from t): each sample gets a pathPalette index.
+// Speed and Curvature run a ramp over two thirds of the hue cycle (red to
+// blue) so the extremes stay apart; Time and Phase go round the whole cycle;
+// Winding is one hue for left turns and the opposite one for right turns.
+enum class ColorBy { Path, Speed, Curvature, Time, Phase, Winding, Count };
+const char* colorByName(ColorBy m);
+
+struct ColorParams {
+    ColorBy by = ColorBy::Path;
+    float   speedRef = 1000.f;     // px/s at the middle of the Speed ramp
+    float   curvatureRef = 20.f;   // radius of curvature (px) at the middle of the Curvature ramp
+    float   timeCycle = 10.f;      // seconds per trip round the hue cycle (Time)
+};
+
+// Phase shows the angle of the term that moves the pen fastest (largest
+// |amp * omega|). nullptr for an empty chain.
+const CompiledChain::Term* dominantTerm(const CompiledChain& c);
+
+// One sample's index from its velocity and acceleration (px/s, px/s^2);
+// hueOffset in degrees, as pathColor's. Not for ColorBy::Path.
+std::uint8_t motionHueIndex(const ColorParams& p, float hueOffset, double t,
+    sf::Vector2f vel, sf::Vector2f acc, const CompiledChain::Term* dominant);
+
+// evalPenBatch plus each sample's index, worked out in the same pass from the
+// derivatives it accumulates (which are not written out).
+void evalPenBatch(const CompiledChain& c, double t0, double dt, std::size_t n,
+    sf::Vector2f* out, std::uint8_t* hue, const ColorParams& p, float hueOffset);
+
+// Splits c for a sampler stepping dt: terms it can resolve (|omega| dt <=
+// maxPhaseStep) go to `slow`; the rest only make aliasing noise at that rate
+// and are summarised by their envelope. Capacity of out.slow is reused.
+struct BandSplit {
+    CompiledChain slow;
+    std::size_t   fastTerms = 0;
+    double        radius = 0.0;        // sum |amp| of the fast terms: how far they stray from slow
+    double        arcRate = 0.0;       // sum |amp * omega|: their path length per second
+    double        slowMaxOmega = 0.0;  // fastest resolved term with |amp| >= minAmp (rad/s)
+};
+void splitBand(const CompiledChain& c, double dt, double maxPhaseStep, double minAmp, BandSplit& out);
+
+// ---------- config text ----------
+// One "R <radius>" line, then one "stage <level> <r> <d> <outside> <speed> <phase>"
+// line per stage. '#' starts a comment.
+void writeChain(std::ostream& os, float R, const std::vector<Stage>& chain);
+// Reads that back. On failure chain and R are untouched and error says
+// which line.
+bool readChain(std::istream& in, float& R, std::vector<Stage>& chain, std::string& error);
+// The per-line step of readChain, for formats that embed chain lines: `word`
+// is the line's first token and `rest` the remainder. Returns false if word
+// is neither "R" nor "stage"; otherwise reads into R or appends to chain and
+// sets `what` ("bad R", "bad stage") if the line is malformed.
+bool readChainLine(const std::string& word, std::istream& rest, float& R, std::vector<Stage>& chain, std::string& what);
@@ -0,0 +1,39 @@
+// StartupProfile.h — time-to-first-frame, broken down by step (--startup-profile)
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+struct StartupProfile {
+    using Clock = std::chrono::steady_clock;
+
+    bool enabled = false;
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+    std::vector<std::pair<const char*, double>> steps;   // name, ms
+    std::size_t firstFrame = 0;                          // steps up to the first present
+
+    // Time since the previous mark is charged to step.
+    void mark(const char* step) {
+        if (!enabled) return;
+        const Clock::time_point now = Clock::now();
+        steps.emplace_back(step, std::chrono::duration<double, std::milli>(now - last).count());
+        last = now;
+    }
+
+    void firstFramePresented() { mark("present (first frame)"); firstFrame = steps.size(); }
+
+    void report(std::ostream& os) const {
+        os << "startup profile (ms since main):\n" << std::fixed << std::setprecision(2);
+        double acc = 0.0;
+        for (std::size_t i = 0; i < steps.size(); ++i) {
+            acc += steps[i].second;
+            os << "  " << std::left << std::setw(24) << steps[i].first << std::right
+                << std::setw(9) << steps[i].second << std::setw(10) << acc << "\n";
+            if (i + 1 == firstFrame) os << "  -- first frame presented at " << acc << " ms --\n";
+        }
+    }
+};
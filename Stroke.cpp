@@ -0,0 +1,129 @@
+// Stroke.cpp — thick line segments with round caps
+
+#include "Stroke.h"
+
+#include <array>
+#include <cmath>
+
+void drawThickSegment(sf::RenderTarget& target,
+    const sf::Vector2f& a, const sf::Vector2f& b,
+    float stroke, const sf::Color& ca, const sf::Color& cb)
+{
+    sf::Vector2f d{ b.x - a.x, b.y - a.y };
+    float len = std::hypot(d.x, d.y);
+    if (len < 0.0001f) return;
+
+    sf::Vector2f n = { -d.y / len, d.x / len };
+    n.x *= (stroke * 0.5f);
+    n.y *= (stroke * 0.5f);
+
+    sf::Vertex quad[4] = {
+        sf::Vertex{ sf::Vector2f{ a.x - n.x, a.y - n.y }, ca },
+        sf::Vertex{ sf::Vector2f{ a.x + n.x, a.y + n.y }, ca },
+        sf::Vertex{ sf::Vector2f{ b.x + n.x, b.y + n.y }, cb },
+        sf::Vertex{ sf::Vector2f{ b.x - n.x, b.y - n.y }, cb }
+    };
+    target.draw(quad, 4, sf::PrimitiveType::TriangleFan);
+
+    float rcap = stroke * 0.5f;
+    sf::CircleShape cap(rcap);
+    cap.setOrigin({ rcap, rcap });
+    cap.setFillColor(ca); cap.setPosition(a); target.draw(cap);
+    cap.setFillColor(cb); cap.setPosition(b); target.draw(cap);
+}
+
+void appendCap(std::vector<sf::Vertex>& out, const sf::Vector2f& c, float radius, const sf::Color& col)
+{
+    constexpr int kSegs = 8;
+    static const auto unit = [] {
+        std::array<sf::Vector2f, kSegs + 1> u{};
+        for (int i = 0; i <= kSegs; ++i) {
+            const float a = 6.2831853f * static_cast<float>(i) / kSegs;
+            u[i] = { std::cos(a), std::sin(a) };
+        }
+        return u;
+    }();
+    for (int i = 0; i < kSegs; ++i) {
+        out.push_back({ c, col });
+        out.push_back({ { c.x + unit[i].x * radius, c.y + unit[i].y * radius }, col });
+        out.push_back({ { c.x + unit[i + 1].x * radius, c.y + unit[i + 1].y * radius }, col });
+    }
+}
+
+void appendThickSegment(std::vector<sf::Vertex>& out,
+    const sf::Vector2f& a, const sf::Vector2f& b,
+    float stroke, const sf::Color& ca, const sf::Color& cb)
+{
+    sf::Vector2f d{ b.x - a.x, b.y - a.y };
+    float len = std::hypot(d.x, d.y);
+    if (len < 0.0001f) return;
+
+    const float h = stroke * 0.5f;
+    const sf::Vector2f n = { -d.y / len * h, d.x / len * h };
+    const sf::Vertex v0{ { a.x - n.x, a.y - n.y }, ca };
+    const sf::Vertex v1{ { a.x + n.x, a.y + n.y }, ca };
+    const sf::Vertex v2{ { b.x + n.x, b.y + n.y }, cb };
+    const sf::Vertex v3{ { b.x - n.x, b.y - n.y }, cb };
+    out.push_back(v0); out.push_back(v1); out.push_back(v2);
+    out.push_back(v0); out.push_back(v2); out.push_back(v3);
+    appendCap(out, b, h, cb);   // joins on a polyline share the end cap
+}
+
+const char* strokeModeName(StrokeMode m) {
+    switch (m) {
+    case StrokeMode::Speed:     return "speed";
+    case StrokeMode::Curvature: return "curvature";
+    case StrokeMode::Nib:       return "nib";
+    default:                    return "constant";
+    }
+}
+
+float strokeWidth(const StrokeParams& p, float stroke, sf::Vector2f v, sf::Vector2f a) {
+    const float speed = std::hypot(v.x, v.y);
+    float k = 1.f;   // 1 = max, 0 = min
+    switch (p.mode) {
+    case StrokeMode::Speed:
+        k = p.speedRef / (p.speedRef + speed);   // fast = thin, like ink
+        break;
+    case StrokeMode::Curvature: {
+        const float curv = speed > 1e-6f ? std::fabs(v.x * a.y - v.y * a.x) / (speed * speed * speed) : 0.f;
+        k = 1.f / (1.f + curv * p.curvatureRef);   // tight turns = thin
+        break;
+    }
+    case StrokeMode::Nib:
+        k = speed > 1e-6f ? std::fabs(std::sin(std::atan2(v.y, v.x) - p.nibAngle)) : 1.f;
+        break;
+    default:
+        return stroke;
+    }
+    return p.min + (p.max - p.min) * k;
+}
+
+void appendVariableStroke(std::vector<sf::Vertex>& out, const sf::Vector2f* pts, const sf::Vector2f* dirs,
+    const float* widths, const sf::Color* cols, std::size_t n)
+{
+    if (n < 2) return;
+    sf::Vector2f nPrev{ 0.f, 0.f };
+    sf::Vertex l0, r0;
+    for (std::size_t i = 0; i < n; ++i) {
+        // normal from the analytic direction; at a cusp (zero velocity) fall
+        // back to the chord, then to the previous normal
+        sf::Vector2f d = dirs[i];
+        float len = std::hypot(d.x, d.y);
+        if (len < 1e-6f) {
+            d = (i + 1 < n) ? pts[i + 1] - pts[i] : pts[i] - pts[i - 1];
+            len = std::hypot(d.x, d.y);
+        }
+        const sf::Vector2f nrm = len > 1e-6f ? sf::Vector2f{ -d.y / len, d.x / len } : nPrev;
+        nPrev = nrm;
+
+        const float h = widths[i] * 0.5f;
+        const sf::Vertex l{ { pts[i].x - nrm.x * h, pts[i].y - nrm.y * h }, cols[i] };
+        const sf::Vertex r{ { pts[i].x + nrm.x * h, pts[i].y + nrm.y * h }, cols[i] };
+        if (i > 0) {
+            out.push_back(l0); out.push_back(r0); out.push_back(r);
+            out.push_back(l0); out.push_back(r); out.push_back(l);
+        }
+        l0 = l; r0 = r;
+    }
+}
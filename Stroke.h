@@ -0,0 +1,43 @@
+// Stroke.h — thick line segments with round caps
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Immediate: one quad + two cap circles, drawn straight to target.
+constexpr int kThickSegmentDrawCalls = 3;
+void drawThickSegment(sf::RenderTarget& target,
+    const sf::Vector2f& a, const sf::Vector2f& b,
+    float stroke, const sf::Color& ca, const sf::Color& cb);
+
+// Batched: appends sf::PrimitiveType::Triangles for the quad plus a round cap
+// at b. Start a polyline with appendCap() at its first point.
+void appendThickSegment(std::vector<sf::Vertex>& out,
+    const sf::Vector2f& a, const sf::Vector2f& b,
+    float stroke, const sf::Color& ca, const sf::Color& cb);
+
+void appendCap(std::vector<sf::Vertex>& out, const sf::Vector2f& c, float radius, const sf::Color& col);
+
+// Calligraphic stroke: the width follows the pen's analytic velocity and
+// acceleration, between min and max (Speed: fast = thin, Curvature: tight
+// turns = thin, Nib: thin along nibAngle). Constant is the plain stroke.
+enum class StrokeMode { Constant, Speed, Curvature, Nib, Count };
+const char* strokeModeName(StrokeMode m);
+
+struct StrokeParams {
+    StrokeMode mode = StrokeMode::Constant;
+    float min = 0.75f;
+    float max = 5.f;
+    float speedRef = 1000.f;      // px/s where a Speed stroke is halfway
+    float curvatureRef = 20.f;    // radius of curvature (px) where a Curvature stroke is halfway
+    float nibAngle = 0.785398f;   // Nib: thinnest when moving along this angle (rad)
+};
+
+// Full width at one sample (px/s, px/s^2); `stroke` for Constant.
+float strokeWidth(const StrokeParams& p, float stroke, sf::Vector2f vel, sf::Vector2f acc);
+
+// Variable width: one Triangles strip through pts[0..n), offset along the
+// normal of dirs[i] (the analytic velocity, so consecutive quads share their
+// edges exactly and the width changes smoothly); widths[i] is the full width.
+void appendVariableStroke(std::vector<sf::Vertex>& out, const sf::Vector2f* pts, const sf::Vector2f* dirs,
+    const float* widths, const sf::Color* cols, std::size_t n);
@@ -0,0 +1,194 @@
+// TraceRebuild.cpp — background re-render of the traced history (see TraceRebuild.h)
+
+#include "TraceRebuild.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Stroke.h"
+
+namespace {
+
+constexpr std::size_t kFramesPerBlock = 64;
+constexpr std::size_t kAheadBlocks = 4;   // per worker, caps buffered geometry
+
+} // namespace
+
+void TraceRebuilder::start(std::vector<TraceRun> runs, const TraceStyle& style, unsigned threads) {
+    cancel();
+    m_runs = std::move(runs);
+    m_style = style;
+    m_blocks.clear();
+    m_ready.clear();
+    m_nextDraw = 0;
+    m_cancel = false;
+
+    for (std::size_t r = 0; r < m_runs.size(); ++r) {
+        const double span = m_runs[r].t1 - m_runs[r].t0;
+        if (span <= 0.0) continue;
+        const auto frames = static_cast<std::size_t>(std::ceil(span / m_style.frameDt));
+        for (std::size_t k = 0; k < frames; k += kFramesPerBlock)
+            m_blocks.push_back({ r, k, std::min(frames, k + kFramesPerBlock) });
+    }
+
+    if (threads == 0) {
+        const unsigned cores = std::thread::hardware_concurrency();   // 0 when unknown
+        threads = cores > 1 ? cores - 1 : 1;
+    }
+    m_thread = std::thread([this, threads] { coordinate(threads); });
+}
+
+void TraceRebuilder::cancel() {
+    if (!m_thread.joinable()) return;
+    m_cancel = true;
+    m_cv.notify_all();
+    m_thread.join();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready.clear();
+}
+
+float TraceRebuilder::progress() const {
+    return m_blocks.empty() ? 1.f : static_cast<float>(m_nextDraw) / static_cast<float>(m_blocks.size());
+}
+
+float TraceRebuilder::measureBlock(const Block& b, TraceScratch& scratch) const {
+    const TraceRun& run = m_runs[b.run];
+    float len = 0.f;
+    for (std::size_t k = b.k0; k < b.k1; ++k) {
+        const double ta = run.t0 + m_style.frameDt * k;
+        const double tb = std::min(run.t1, ta + m_style.frameDt);
+        traceFrame(run.chain, ta, tb, m_style, scratch,
+            [&](sf::Vector2f p, sf::Vector2f q, const std::uint8_t*, const float*, const sf::Vector2f*) {
+                len += std::hypot(q.x - p.x, q.y - p.y);
+            });
+    }
+    return len;
+}
+
+void TraceRebuilder::buildBlock(const Block& b, TraceScratch& scratch, std::vector<sf::Vertex>& out) const {
+    const TraceRun& run = m_runs[b.run];
+    const TraceStyle& st = m_style;
+    double len = b.len0;
+    const auto& pal = pathPalette();
+    if (st.calligraphy.mode != StrokeMode::Constant) {
+        buildVariableBlock(b, scratch, out);
+        return;
+    }
+    if (b.k0 == 0) {
+        sf::Vector2f p0, v0, a0;
+        evalPenBatch(run.chain, run.t0, 0.0, 1, &p0, &v0, &a0);
+        const sf::Color c0 = st.color.by == ColorBy::Path ? pathColor(len, st.pixelsPerCycle, st.hueOffset)
+            : pal[motionHueIndex(st.color, st.hueOffset, run.t0, v0, a0, dominantTerm(run.chain))];
+        appendCap(out, st.center + p0, st.stroke * 0.5f, c0);
+    }
+
+    for (std::size_t k = b.k0; k < b.k1; ++k) {
+        const double ta = run.t0 + st.frameDt * k;
+        const double tb = std::min(run.t1, ta + st.frameDt);
+        traceFrame(run.chain, ta, tb, st, scratch, [&](sf::Vector2f p, sf::Vector2f q, const std::uint8_t* hue,
+            const float*, const sf::Vector2f*) {
+            const double len0 = len;
+            len += std::hypot(q.x - p.x, q.y - p.y);
+            if (hue) appendThickSegment(out, p, q, st.stroke, pal[hue[0]], pal[hue[1]]);
+            else appendThickSegment(out, p, q, st.stroke,
+                pathColor(len0, st.pixelsPerCycle, st.hueOffset),
+                pathColor(len, st.pixelsPerCycle, st.hueOffset));
+            });
+    }
+}
+
+// The calligraphic stroke as the live tracer draws it: the block is one
+// variable-width strip, offset along the analytic velocity, without caps.
+// Its first point is the previous block's last, so the strips join exactly.
+void TraceRebuilder::buildVariableBlock(const Block& b, TraceScratch& scratch, std::vector<sf::Vertex>& out) const {
+    const TraceRun& run = m_runs[b.run];
+    const TraceStyle& st = m_style;
+    double len = b.len0;
+    const auto& pal = pathPalette();
+    std::vector<sf::Vector2f> pts, vel;
+    std::vector<float> width;
+    std::vector<sf::Color> col;
+    for (std::size_t k = b.k0; k < b.k1; ++k) {
+        const double ta = run.t0 + st.frameDt * k;
+        const double tb = std::min(run.t1, ta + st.frameDt);
+        traceFrame(run.chain, ta, tb, st, scratch, [&](sf::Vector2f p, sf::Vector2f q, const std::uint8_t* hue,
+            const float* w, const sf::Vector2f* v) {
+            if (pts.empty()) {
+                pts.push_back(p); vel.push_back(v[0]); width.push_back(w[0]);
+                col.push_back(hue ? pal[hue[0]] : pathColor(len, st.pixelsPerCycle, st.hueOffset));
+            }
+            len += std::hypot(q.x - p.x, q.y - p.y);
+            pts.push_back(q); vel.push_back(v[1]); width.push_back(w[1]);
+            col.push_back(hue ? pal[hue[1]] : pathColor(len, st.pixelsPerCycle, st.hueOffset));
+            });
+    }
+    appendVariableStroke(out, pts.data(), vel.data(), width.data(), col.data(), pts.size());
+}
+
+void TraceRebuilder::coordinate(unsigned threads) {
+    std::atomic<std::size_t> next{ 0 };
+    std::vector<std::thread> pool;
+
+    // pass 1: path length per block
+    for (unsigned i = 0; i < threads; ++i) {
+        pool.emplace_back([&] {
+            TraceScratch scratch;
+            for (std::size_t b; !m_cancel && (b = next++) < m_blocks.size(); )
+                m_blocks[b].len = measureBlock(m_blocks[b], scratch);
+            });
+    }
+    for (auto& th : pool) th.join();
+    pool.clear();
+    if (m_cancel) return;
+
+    // prefix sums restart at each run's recorded rainbow position
+    for (std::size_t b = 0; b < m_blocks.size(); ++b) {
+        Block& blk = m_blocks[b];
+        blk.len0 = (b > 0 && m_blocks[b - 1].run == blk.run)
+            ? m_blocks[b - 1].len0 + m_blocks[b - 1].len
+            : m_runs[blk.run].pathLen0;
+    }
+
+    // pass 2: geometry, handed to the main thread in order
+    next = 0;
+    const std::size_t window = kAheadBlocks * threads;
+    for (unsigned i = 0; i < threads; ++i) {
+        pool.emplace_back([&] {
+            TraceScratch scratch;
+            for (std::size_t b; !m_cancel && (b = next++) < m_blocks.size(); ) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock, [&] { return m_cancel || b < m_nextDraw + window; });
+                    if (m_cancel) return;
+                }
+                std::vector<sf::Vertex> verts;
+                buildBlock(m_blocks[b], scratch, verts);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_ready.emplace(b, std::move(verts));
+            }
+            });
+    }
+    for (auto& th : pool) th.join();
+}
+
+bool TraceRebuilder::pump(sf::RenderTarget& target, const sf::RenderStates& states, std::size_t vertexBudget) {
+    std::size_t drawn = 0;
+    while (drawn < vertexBudget) {
+        std::vector<sf::Vertex> verts;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_ready.find(m_nextDraw);
+            if (it == m_ready.end()) break;
+            verts = std::move(it->second);
+            m_ready.erase(it);
+            ++m_nextDraw;
+        }
+        m_cv.notify_all();
+        if (!verts.empty()) target.draw(verts.data(), verts.size(), sf::PrimitiveType::Triangles, states);
+        drawn += verts.size();
+    }
+
+    const bool done = m_nextDraw >= m_blocks.size();
+    if (done && m_thread.joinable()) m_thread.join();
+    return done;
+}
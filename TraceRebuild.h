@@ -0,0 +1,152 @@
+// TraceRebuild.h — re-render the traced history into a new canvas in the background
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Spirograph.h"
+#include "Stroke.h"
+
+// One stretch of tracing with fixed parameters. A new run starts whenever
+// tracing restarts or the chain is edited, so the history can be replayed
+// exactly as it was drawn.
+struct TraceRun {
+    CompiledChain chain;
+    double t0 = 0.0, t1 = 0.0;
+    double pathLen0 = 0.0;   // rainbow position at t0
+};
+
+struct TraceStyle {
+    sf::Vector2f center;           // logical screen center
+    float  stroke = 2.f;
+    float  maxPixelStep = 1.f;     // logical pixels
+    int    maxSubsteps = 256;
+    float  pixelsPerCycle = 600.f;
+    float  hueOffset = 0.f;
+    double frameDt = 1.0 / 120.0;  // replayed frame length (live rule: sub-steps per frame)
+    ColorParams color;             // ColorBy::Path: the callers colour by length
+    StrokeParams calligraphy;      // Constant: every segment is `stroke` wide
+};
+
+struct TraceScratch {
+    std::vector<sf::Vector2f> pos, vel, acc;
+    std::vector<std::uint8_t> hue;
+    std::vector<float>        width;
+};
+
+// Replays the live sub-stepping rule for one frame [ta, tb]: the number of
+// sub-steps follows the endpoint distance, capped at maxSubsteps.
+// emit(p, q, hue, width, vel) sees each sub-segment; hue points at the
+// palette indices of p and q, or is null for ColorBy::Path (the caller has
+// the path length). With a calligraphic stroke width and vel point at the
+// full widths and analytic velocities at p and q, as the live tracer's;
+// otherwise both are null and the width is `stroke`.
+template <class Emit>
+void traceFrame(const CompiledChain& c, double ta, double tb, const TraceStyle& st,
+    TraceScratch& scratch, Emit&& emit)
+{
+    const sf::Vector2f a = st.center + evalPen(c, ta);
+    const sf::Vector2f b = st.center + evalPen(c, tb);
+    int steps = static_cast<int>(std::ceil(std::hypot(b.x - a.x, b.y - a.y) / std::max(0.1f, st.maxPixelStep)));
+    steps = std::clamp(steps, 1, st.maxSubsteps);
+
+    const double h = (tb - ta) / steps;
+    const std::size_t n = static_cast<std::size_t>(steps);
+    if (st.calligraphy.mode != StrokeMode::Constant) {
+        // derivatives for all n + 1 points from ta; widths and motion colours from them
+        scratch.pos.resize(n + 1); scratch.vel.resize(n + 1); scratch.acc.resize(n + 1);
+        evalPenBatch(c, ta, h, n + 1, scratch.pos.data(), scratch.vel.data(), scratch.acc.data());
+        scratch.width.resize(n + 1);
+        for (std::size_t k = 0; k <= n; ++k)
+            scratch.width[k] = strokeWidth(st.calligraphy, st.stroke, scratch.vel[k], scratch.acc[k]);
+        const bool motion = st.color.by != ColorBy::Path;
+        if (motion) {
+            const CompiledChain::Term* dom = st.color.by == ColorBy::Phase ? dominantTerm(c) : nullptr;
+            scratch.hue.resize(n + 1);
+            for (std::size_t k = 0; k <= n; ++k)
+                scratch.hue[k] = motionHueIndex(st.color, st.hueOffset, ta + h * k, scratch.vel[k], scratch.acc[k], dom);
+        }
+        sf::Vector2f prev = a;
+        for (std::size_t k = 1; k <= n; ++k) {
+            const sf::Vector2f p = st.center + scratch.pos[k];
+            emit(prev, p, motion ? &scratch.hue[k - 1] : static_cast<const std::uint8_t*>(nullptr),
+                &scratch.width[k - 1], &scratch.vel[k - 1]);
+            prev = p;
+        }
+        return;
+    }
+
+    if (st.color.by == ColorBy::Path) {
+        scratch.pos.resize(n);
+        evalPenBatch(c, ta + h, h, n, scratch.pos.data());
+        sf::Vector2f prev = a;
+        for (sf::Vector2f p : scratch.pos) {
+            p += st.center;
+            emit(prev, p, static_cast<const std::uint8_t*>(nullptr),
+                static_cast<const float*>(nullptr), static_cast<const sf::Vector2f*>(nullptr));
+            prev = p;
+        }
+        return;
+    }
+
+    // from ta, for the first point's colour
+    scratch.pos.resize(n + 1);
+    scratch.hue.resize(n + 1);
+    evalPenBatch(c, ta, h, n + 1, scratch.pos.data(), scratch.hue.data(), st.color, st.hueOffset);
+    sf::Vector2f prev = a;
+    for (std::size_t k = 1; k <= n; ++k) {
+        const sf::Vector2f p = st.center + scratch.pos[k];
+        emit(prev, p, &scratch.hue[k - 1], static_cast<const float*>(nullptr), static_cast<const sf::Vector2f*>(nullptr));
+        prev = p;
+    }
+}
+
+// Parallel generator: the runs are cut into blocks of frames; workers first
+// measure each block's path length (so rainbow colours can be prefix-summed),
+// then build triangle batches. The main thread draws finished blocks in order
+// with pump(); workers stay a bounded number of blocks ahead.
+class TraceRebuilder {
+public:
+    ~TraceRebuilder() { cancel(); }
+
+    void start(std::vector<TraceRun> runs, const TraceStyle& style, unsigned threads = 0);
+    void cancel();
+
+    bool  active() const { return m_thread.joinable(); }
+    float progress() const;
+
+    // Draws ready blocks (in order) until about vertexBudget vertices have gone
+    // out. Returns true once the whole history has been drawn.
+    bool pump(sf::RenderTarget& target, const sf::RenderStates& states, std::size_t vertexBudget);
+
+private:
+    struct Block {
+        std::size_t run;
+        std::size_t k0, k1;     // frame interval range within the run
+        float len = 0.f;
+        double len0 = 0.0;      // path length at block start
+    };
+
+    void coordinate(unsigned threads);
+    float measureBlock(const Block& b, TraceScratch& scratch) const;
+    void  buildBlock(const Block& b, TraceScratch& scratch, std::vector<sf::Vertex>& out) const;
+    void  buildVariableBlock(const Block& b, TraceScratch& scratch, std::vector<sf::Vertex>& out) const;
+
+    std::vector<TraceRun> m_runs;
+    std::vector<Block>    m_blocks;
+    TraceStyle            m_style;
+
+    std::thread             m_thread;
+    std::atomic<bool>       m_cancel{ false };
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::map<std::size_t, std::vector<sf::Vertex>> m_ready;
+    std::size_t             m_nextDraw = 0;
+};
@@ -0,0 +1,272 @@
+// Tracer.h — live trace: adaptive sub-sampling from last frame's pen to this frame's
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "IndexedCanvas.h"
+#include "Nco.h"
+#include "Spirograph.h"
+#include "Stroke.h"
+
+struct Tracer {
+    // --- trace resolution control ---
+    float maxPixelStep = 1.0f; // max pixels per sub-segment; lower = smoother
+    int   maxSubsteps = 256;   // safety cap
+
+    // Rainbow path control
+    float pixelsPerCycle = 600.f;
+    float hueOffset = 0.f;
+    float stroke = 2.f;        // one global stroke for the thick segments
+
+    // Calligraphic stroke (see StrokeParams), driven by the analytic pen
+    // velocity / acceleration. Needs `compiled` (the chain passed to advance,
+    // compiled); falls back to `stroke` without it.
+    StrokeParams calligraphy;
+    const CompiledChain* compiled = nullptr;
+
+    // Colour by pen motion instead of path length (needs `compiled`). The
+    // indices come from the batch evaluator's analytic derivatives, and so do
+    // the positions (unless `nco` is set), which makes these modes cheaper per
+    // sub-step than the rainbow's penAt. Path length still accumulates, so
+    // switching back continues the rainbow.
+    ColorParams color;
+    // Band limiting (needs `compiled` too): terms that turn more than
+    // bandPhaseStep per sub-step even at maxSubsteps cannot be sampled, only
+    // aliased. They are dropped from the sampled path, which is then drawn as
+    // a band as wide as their combined reach, at the ink density their path
+    // length would lay down over it.
+    bool  bandLimit = false;
+    float bandPhaseStep = 1.5707963f;   // rad per sub-step (4 samples per turn)
+    BandSplit band;                     // last frame's split
+    NcoChain  bandNco;                  // band.slow for the NCO evaluator, when `nco` is set
+    CompiledChain bandNcoSrc;           // ...compiled from these terms
+
+    // When set, positions come from the integer NCO evaluator (at the nearest
+    // tick) instead of penAtTime, the band's centre included. Must be compiled
+    // from the chain passed in.
+    const NcoChain* nco = nullptr;
+
+    // run state
+    bool         haveLast = false;
+    sf::Vector2f lastPen{};
+    double       lastT = 0.0;  // keep last time for sub-stepping
+    double       pathLen = 0.0;   // doubles: both grow without bound over a long run
+
+    // per-frame scratch for the calligraphic path (capacity is kept)
+    std::vector<sf::Vector2f> scratchPos, scratchVel, scratchAcc, scratchPts;
+    std::vector<float>        scratchWidth;
+    std::vector<std::uint8_t> scratchHue;
+    std::vector<sf::Color>    scratchCol;
+    std::vector<sf::Vertex>   strip;
+
+    void stop() { haveLast = false; }
+    void clear() { haveLast = false; pathLen = 0.0; }
+
+    sf::Vector2f penAt(float R, const std::vector<Stage>& chain, double t) const {
+        return nco ? evalPenNco(*nco, ncoTicks(t)) : penAtTime(R, chain, t);
+    }
+
+    bool variableStroke() const { return calligraphy.mode != StrokeMode::Constant && compiled; }
+    bool motionColor() const { return color.by != ColorBy::Path && compiled; }
+    // Last advance() went out as one strip draw (variable stroke or band).
+    bool batchedDraw() const { return variableStroke() || band.fastTerms > 0; }
+
+    float widthFor(sf::Vector2f v, sf::Vector2f a) const { return strokeWidth(calligraphy, stroke, v, a); }
+
+    // Draws from the previous call's pen to the pen at t. Target is an
+    // sf::RenderTarget or an IndexedCanvas. pixelScale is canvas pixels per
+    // logical pixel, so sub-steps stay maxPixelStep apart on the canvas.
+    // onSegment(ti, p0, p1, c0, c1) sees every sub-segment drawn (ti a double).
+    // Returns the number of sub-steps.
+    template <class Target, class OnSegment>
+    int advance(Target& target, float R, const std::vector<Stage>& chain,
+        sf::Vector2f center, double t, float pixelScale, OnSegment&& onSegment)
+    {
+        // where we *want* to be this frame
+        const sf::Vector2f currPen = center + penAt(R, chain, t);
+
+        if (!haveLast) {
+            // first point in a run
+            haveLast = true;
+            lastPen = currPen;
+            lastT = t;
+        }
+
+        band.fastTerms = 0;
+        if (bandLimit && compiled && t > lastT) {
+            splitBand(*compiled, (t - lastT) / maxSubsteps, bandPhaseStep,
+                maxPixelStep / pixelScale, band);
+            if (band.fastTerms > 0) return advanceBand(target, center, currPen, t, pixelScale, onSegment);
+        }
+
+        // Decide how many sub-steps based on canvas distance
+        const float dist = std::hypot(currPen.x - lastPen.x, currPen.y - lastPen.y);
+        int steps = static_cast<int>(std::ceil(dist / std::max(0.1f, maxPixelStep / pixelScale)));
+        steps = std::clamp(steps, 1, maxSubsteps);
+
+        sf::Vector2f prev = lastPen;
+
+        // calligraphic: derivatives for all steps + 1 points in one batch; the
+        // segments become one variable-width strip drawn once at the end
+        const bool variable = variableStroke();
+        const bool motion = motionColor();
+        const auto& pal = pathPalette();
+        const std::size_t n = static_cast<std::size_t>(steps) + 1;
+        if (variable) {
+            scratchPos.resize(n); scratchVel.resize(n); scratchAcc.resize(n);
+            evalPenBatch(*compiled, lastT, (t - lastT) / steps, n,
+                scratchPos.data(), scratchVel.data(), scratchAcc.data());
+            scratchWidth.resize(n);
+            for (std::size_t k = 0; k < n; ++k) scratchWidth[k] = widthFor(scratchVel[k], scratchAcc[k]);
+        }
+        if (motion) {
+            // the widths' derivatives serve the colours too
+            scratchHue.resize(n);
+            if (variable) {
+                const CompiledChain::Term* dom = color.by == ColorBy::Phase ? dominantTerm(*compiled) : nullptr;
+                for (std::size_t k = 0; k < n; ++k)
+                    scratchHue[k] = motionHueIndex(color, hueOffset, lastT + (t - lastT) * k / steps, scratchVel[k], scratchAcc[k], dom);
+            }
+            else {
+                scratchPos.resize(n);
+                evalPenBatch(*compiled, lastT, (t - lastT) / steps, n, scratchPos.data(), scratchHue.data(), color, hueOffset);
+            }
+        }
+        if (variable) {
+            scratchPts.assign(1, prev);
+            scratchCol.assign(1, motion ? pal[scratchHue[0]] : pathColor(pathLen, pixelsPerCycle, hueOffset));
+        }
+
+        for (int i = 1; i <= steps; ++i) {
+            double ti = lastT + (t - lastT) * i / steps;
+
+            sf::Vector2f p = center + (motion && !nco ? scratchPos[i] : penAt(R, chain, ti));
+
+            // rainbow by length (small segments, smooth gradient)
+            double prevLen = pathLen;
+            pathLen += std::hypot(p.x - prev.x, p.y - prev.y);
+
+            sf::Color c0 = motion ? pal[scratchHue[i - 1]] : pathColor(prevLen, pixelsPerCycle, hueOffset);
+            sf::Color c1 = motion ? pal[scratchHue[i]] : pathColor(pathLen, pixelsPerCycle, hueOffset);
+
+            if constexpr (std::is_base_of_v<sf::RenderTarget, Target>) {
+                if (variable) { scratchPts.push_back(p); scratchCol.push_back(c1); }
+                else drawThickSegment(target, prev, p, stroke, c0, c1);
+            }
+            else {
+                const float w = variable ? 0.5f * (scratchWidth[i - 1] + scratchWidth[i]) : stroke;
+                target.drawSegment(prev, p, w,
+                    motion ? scratchHue[i - 1] : pathHueIndex(prevLen, pixelsPerCycle, hueOffset),
+                    motion ? scratchHue[i] : pathHueIndex(pathLen, pixelsPerCycle, hueOffset));
+            }
+            onSegment(ti, prev, p, c0, c1);
+
+            prev = p;
+        }
+
+        if constexpr (std::is_base_of_v<sf::RenderTarget, Target>) {
+            if (variable) {
+                strip.clear();
+                appendVariableStroke(strip, scratchPts.data(), scratchVel.data(), scratchWidth.data(),
+                    scratchCol.data(), scratchPts.size());
+                if (!strip.empty()) target.draw(strip.data(), strip.size(), sf::PrimitiveType::Triangles);
+            }
+        }
+
+        // finalize for next frame
+        lastPen = currPen;
+        lastT = t;
+        return steps;
+    }
+
+    // advance() for a frame with unresolvable terms: samples only band.slow
+    // (so far fewer steps) and draws the envelope as one wide strip.
+    template <class Target, class OnSegment>
+    int advanceBand(Target& target, sf::Vector2f center, sf::Vector2f currPen, double t, float pixelScale,
+        OnSegment& onSegment) {
+        const double span = t - lastT;
+        const sf::Vector2f a = evalPen(band.slow, lastT), b = evalPen(band.slow, t);
+        int steps = static_cast<int>(std::ceil(std::hypot(b.x - a.x, b.y - a.y) / std::max(0.1f, maxPixelStep / pixelScale)));
+        // curl from resolved terms too small to matter is left to the distance test
+        steps = std::max(steps, static_cast<int>(std::ceil(band.slowMaxOmega * span / bandPhaseStep)));
+        steps = std::clamp(steps, 1, maxSubsteps);
+
+        const std::size_t n = static_cast<std::size_t>(steps) + 1;
+        scratchPos.resize(n); scratchVel.resize(n); scratchAcc.resize(n);
+        evalPenBatch(band.slow, lastT, span / steps, n, scratchPos.data(), scratchVel.data(), scratchAcc.data());
+        if (nco) {
+            // the centre from the integer evaluator too; the split changes rarely
+            const auto same = [](const CompiledChain::Term& x, const CompiledChain::Term& y) {
+                return x.amp == y.amp && x.omega == y.omega && x.phase == y.phase;
+            };
+            if (!std::equal(band.slow.terms.begin(), band.slow.terms.end(),
+                    bandNcoSrc.terms.begin(), bandNcoSrc.terms.end(), same)) {
+                bandNcoSrc.terms = band.slow.terms;
+                bandNco = compileNco(bandNcoSrc);
+            }
+            for (std::size_t k = 0; k < n; ++k)
+                scratchPos[k] = evalPenNco(bandNco, ncoTicks(lastT + span * k / steps));
+        }
+
+        const float radius = static_cast<float>(band.radius);
+        const float width = 2.f * radius + stroke;
+        float slowLen = 0.f;
+        for (std::size_t k = 1; k < n; ++k)
+            slowLen += std::hypot(scratchPos[k].x - scratchPos[k - 1].x, scratchPos[k].y - scratchPos[k - 1].y);
+        const float fastLen = static_cast<float>(band.arcRate * span);
+        const float cover = std::clamp(stroke * (slowLen + fastLen) / (width * slowLen + 3.14159f * radius * radius + 1e-3f), 0.05f, 1.f);
+        auto faded = [cover](sf::Color c) { c.a = static_cast<std::uint8_t>(c.a * cover + 0.5f); return c; };
+
+        // motion colours follow the sampled (slow) path; Phase keeps the full chain's dominant term
+        const bool motion = motionColor();
+        const auto& pal = pathPalette();
+        if (motion) {
+            const CompiledChain::Term* dom = color.by == ColorBy::Phase ? dominantTerm(*compiled) : nullptr;
+            scratchHue.resize(n);
+            for (std::size_t k = 0; k < n; ++k)
+                scratchHue[k] = motionHueIndex(color, hueOffset, lastT + span * k / steps, scratchVel[k], scratchAcc[k], dom);
+        }
+
+        sf::Vector2f prev = center + scratchPos[0];
+        scratchPts.assign(1, prev);
+        scratchCol.assign(1, faded(motion ? pal[scratchHue[0]] : pathColor(pathLen, pixelsPerCycle, hueOffset)));
+        for (int i = 1; i <= steps; ++i) {
+            const double ti = lastT + span * i / steps;
+            const sf::Vector2f p = center + scratchPos[i];
+            const double prevLen = pathLen;
+            pathLen += std::hypot(p.x - prev.x, p.y - prev.y) + fastLen / steps;
+            const sf::Color c0 = faded(motion ? pal[scratchHue[i - 1]] : pathColor(prevLen, pixelsPerCycle, hueOffset));
+            const sf::Color c1 = faded(motion ? pal[scratchHue[i]] : pathColor(pathLen, pixelsPerCycle, hueOffset));
+
+            if constexpr (std::is_base_of_v<sf::RenderTarget, Target>) {
+                scratchPts.push_back(p);
+                scratchCol.push_back(c1);
+            }
+            else {
+                target.drawSegment(prev, p, width,
+                    motion ? scratchHue[i - 1] : pathHueIndex(prevLen, pixelsPerCycle, hueOffset),
+                    motion ? scratchHue[i] : pathHueIndex(pathLen, pixelsPerCycle, hueOffset), cover);
+            }
+            onSegment(ti, prev, p, c0, c1);
+            prev = p;
+        }
+
+        if constexpr (std::is_base_of_v<sf::RenderTarget, Target>) {
+            scratchWidth.assign(n, width);
+            strip.clear();
+            appendVariableStroke(strip, scratchPts.data(), scratchVel.data(), scratchWidth.data(),
+                scratchCol.data(), scratchPts.size());
+            if (!strip.empty()) target.draw(strip.data(), strip.size(), sf::PrimitiveType::Triangles);
+        }
+
+        // the real pen, not the band's centre: if the band ends (K, or fewer
+        // fast terms) the next plain advance starts from where the pen is
+        lastPen = currPen;
+        lastT = t;
+        return steps;
+    }
+};
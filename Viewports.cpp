@@ -0,0 +1,54 @@
+// Viewports.cpp — shared-sample views (see Viewports.h)
+
+#include "Viewports.h"
+
+#include <algorithm>
+
+#include "Stroke.h"
+
+sf::View fitView(sf::Vector2f center, sf::Vector2f worldSize, const sf::FloatRect& px, sf::Vector2u win) {
+    const float scale = std::min(px.size.x / worldSize.x, px.size.y / worldSize.y);
+    sf::View v(center, { px.size.x / scale, px.size.y / scale });
+    v.setViewport(sf::FloatRect({ px.position.x / win.x, px.position.y / win.y },
+        { px.size.x / win.x, px.size.y / win.y }));
+    return v;
+}
+
+void ZoomView::recenter(sf::Vector2f focus, const sf::ContextSettings& settings) {
+    focus_ = focus;
+    if (!ready_) ready_ = rt_.resize({ pixels, pixels }, settings);
+    if (!ready_) return;
+    rt_.setSmooth(true);
+    clear();
+}
+
+void ZoomView::clear() {
+    if (!ready_) return;
+    const float half = worldSize() * 0.5f;
+    rt_.setView(sf::View(focus_, { 2.f * half, 2.f * half }));
+    rt_.clear(sf::Color::Transparent);
+    rt_.display();
+}
+
+void ZoomView::consume(const FrameSamples& s, float stroke) {
+    if (!ready_ || s.segments.empty()) return;
+    const float reach = worldSize() * 0.5f + stroke;
+    batch_.clear();
+    for (const FrameSamples::Segment& g : s.segments) {
+        if (std::min(g.a.x, g.b.x) > focus_.x + reach || std::max(g.a.x, g.b.x) < focus_.x - reach ||
+            std::min(g.a.y, g.b.y) > focus_.y + reach || std::max(g.a.y, g.b.y) < focus_.y - reach)
+            continue;
+        appendThickSegment(batch_, g.a, g.b, stroke, g.ca, g.cb);
+    }
+    if (batch_.empty()) return;
+    rt_.draw(batch_.data(), batch_.size(), sf::PrimitiveType::Triangles);
+    rt_.display();
+}
+
+sf::Sprite ZoomView::sprite() const {
+    sf::Sprite sp(rt_.getTexture());
+    sp.setOrigin({ pixels * 0.5f, pixels * 0.5f });
+    sp.setPosition(focus_);
+    sp.setScale({ 1.f / zoom, 1.f / zoom });
+    return sp;
+}
@@ -0,0 +1,51 @@
+// Viewports.h — side-by-side views fed from one per-frame sample buffer
+//
+// The tracer's segments and the stage centres are produced once per frame
+// into FrameSamples; every view consumes that buffer with its own transform
+// (and, for the zoom, its own canvas) instead of evaluating the chain again.
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// What this frame produced, in logical (world) coordinates.
+struct FrameSamples {
+    struct Segment { sf::Vector2f a, b; sf::Color ca, cb; };
+    std::vector<Segment>      segments;   // traced this frame, in order
+    std::vector<sf::Vector2f> centers;    // stage centres, local (add the screen centre)
+    sf::Vector2f              pen{};
+
+    void clearSegments() { segments.clear(); }   // capacity is kept
+};
+
+// Letterboxed view showing worldSize around center inside the window-pixel
+// rectangle `px` of a window `win` pixels big.
+sf::View fitView(sf::Vector2f center, sf::Vector2f worldSize, const sf::FloatRect& px, sf::Vector2u win);
+
+// Detail view with its own canvas: a square world region of pixels / zoom
+// logical units around a focus point, traced at zoom canvas pixels per unit.
+class ZoomView {
+public:
+    float    zoom = 4.f;
+    unsigned pixels = 640;
+
+    // New region around focus; drops what was traced.
+    void recenter(sf::Vector2f focus, const sf::ContextSettings& settings);
+    void clear();
+
+    // Draws this frame's segments that touch the region, in one batch.
+    void consume(const FrameSamples& s, float stroke);
+
+    bool ready() const { return ready_; }
+    sf::Vector2f focus() const { return focus_; }
+    float worldSize() const { return pixels / zoom; }
+
+    // The canvas as a sprite in world coordinates.
+    sf::Sprite sprite() const;
+
+private:
+    sf::RenderTexture rt_;
+    sf::Vector2f focus_{};
+    bool ready_ = false;
+    std::vector<sf::Vertex> batch_;
+};
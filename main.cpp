@@ -10,124 +10,40 @@
 #include <iomanip>
 #include <cstdint>
 #include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include "AllocTracker.h"
+#include "Animation.h"
+#include "Conformance.h"
+#include "ControlSocket.h"
+#include "EmbeddedFont.h"
+#include "ExportJobs.h"
+#include "FlightRecorder.h"
+#include "Golden.h"
+#include "Heatmap.h"
+#include "IndexedCanvas.h"
+#include "Jobs.h"
+#include "Latency.h"
+#include "MechanismBlur.h"
+#include "Nco.h"
+#include "Options.h"
+#include "PostFx.h"
+#include "SampleStream.h"
+#include "Sheet.h"
+#include "Soak.h"
+#include "Spiro3D.h"
+#include "Spirograph.h"
+#include "StartupProfile.h"
+#include "TraceRebuild.h"
+#include "Tracer.h"
+#include "Viewports.h"
 
 // ---------- helpers ----------
 static inline sf::Vector2f V2(float x, float y) { return { x, y }; }
 
-static sf::Color hsv(float h, float s, float v, std::uint8_t a = 230) {
-    float c = v * s;
-    float x = c * (1.f - std::fabs(std::fmod(h / 60.f, 2.f) - 1.f));
-    float m = v - c;
-    float r = 0, g = 0, b = 0;
-    if (h < 60) { r = c; g = x; b = 0; }
-    else if (h < 120) { r = x; g = c; b = 0; }
-    else if (h < 180) { r = 0; g = c; b = x; }
-    else if (h < 240) { r = 0; g = x; b = c; }
-    else if (h < 300) { r = x; g = 0; b = c; }
-    else { r = c; g = 0; b = x; }
-    auto to8 = [](float u) { return static_cast<std::uint8_t>(std::round(u * 255.f)); };
-    return sf::Color(to8(r + m), to8(g + m), to8(b + m), a);
-}
-
-static void drawThickSegment(sf::RenderTarget& target,
-    const sf::Vector2f& a, const sf::Vector2f& b,
-    float stroke, const sf::Color& ca, const sf::Color& cb)
-{
-    sf::Vector2f d{ b.x - a.x, b.y - a.y };
-    float len = std::hypot(d.x, d.y);
-    if (len < 0.0001f) return;
-
-    sf::Vector2f n = { -d.y / len, d.x / len };
-    n.x *= (stroke * 0.5f);
-    n.y *= (stroke * 0.5f);
-
-    sf::Vertex quad[4] = {
-        sf::Vertex{ sf::Vector2f{ a.x - n.x, a.y - n.y }, ca },
-        sf::Vertex{ sf::Vector2f{ a.x + n.x, a.y + n.y }, ca },
-        sf::Vertex{ sf::Vector2f{ b.x + n.x, b.y + n.y }, cb },
-        sf::Vertex{ sf::Vector2f{ b.x - n.x, b.y - n.y }, cb }
-    };
-    target.draw(quad, 4, sf::PrimitiveType::TriangleFan);
-
-    float rcap = stroke * 0.5f;
-    sf::CircleShape cap(rcap);
-    cap.setOrigin({ rcap, rcap });
-    cap.setFillColor(ca); cap.setPosition(a); target.draw(cap);
-    cap.setFillColor(cb); cap.setPosition(b); target.draw(cap);
-}
-
-// ---------- model ----------
-struct Stage {
-    int   level = 1;     // 1 = first nested disc
-    float r;             // rolling disc radius
-    float d;             // pen offset (used only by the LAST stage)
-    bool  outside;       // false = inside roll; true = outside roll
-    float speed;         // radians/sec (negative = reverse)
-    float phase;         // start angle (radians)
-
-    // (style for last stage trace — kept for future use)
-    float stroke = 6.f;
-    bool  rainbow = true;
-    float pixelsPerCycle = 600.f;
-    float hueOffset = 0.f;
-
-    // visuals
-    sf::CircleShape disc;
-
-    Stage(int lvl, float rr, float dd, bool out, float spd, float ph = -3.14159f / 2.f)
-        : level(lvl), r(rr), d(dd), outside(out), speed(spd), phase(ph), disc(rr)
-    {
-        disc.setOrigin({ r, r });
-        disc.setFillColor(sf::Color::Transparent);
-        disc.setOutlineThickness(2.f);
-        disc.setOutlineColor(sf::Color(140, 200, 255));
-        disc.setPointCount(140);
-    }
-};
-
-// Nested centers + pen with per-stage speeds.
-// Returns local coords (add screen center to draw).
-static sf::Vector2f nestedPenAndCenters_perStageSpeed(float R,
-    const std::vector<Stage>& stages,
-    float t,
-    std::vector<sf::Vector2f>* outCenters)
-{
-    if (outCenters) outCenters->clear();
-    sf::Vector2f acc{ 0.f, 0.f };
-    float baseRadius = R;
-
-    for (std::size_t j = 0; j < stages.size(); ++j) {
-        const Stage& s = stages[j];
-        float alpha = s.speed * t + s.phase;
-        float kappa = s.outside ? (baseRadius + s.r) : (baseRadius - s.r);
-
-        acc.x += kappa * std::cos(alpha);
-        acc.y += kappa * std::sin(alpha);
-        if (outCenters) outCenters->push_back(acc);
-
-        bool last = (j + 1 == stages.size());
-        if (last) {
-            float freq = kappa / s.r;
-            float beta = freq * alpha;
-            float ox, oy;
-            if (s.outside) { ox = -s.d * std::cos(beta); oy = -s.d * std::sin(beta); }
-            else { ox = s.d * std::cos(beta); oy = -s.d * std::sin(beta); }
-            acc.x += ox; acc.y += oy;
-        }
-        else {
-            baseRadius = s.r; // next stage rolls on this disc
-        }
-    }
-    return acc;
-}
-
-// Returns the pen *local* position at time t (no centers allocated)
-static inline sf::Vector2f penAtTime(float R,
-    const std::vector<Stage>& chain,
-    float t) {
-    return nestedPenAndCenters_perStageSpeed(R, chain, t, nullptr);
-}
-
 // ---------- help overlay ----------
 struct HelpOverlay {
     bool visible = false;
@@ -151,11 +67,27 @@ struct HelpOverlay {
             "Controls\n"
             "------------\n"
             "General\n"
-            "  Esc          Quit\n"
+            "  Esc          Cancel job / quit\n"
             "  Space        Trace on/off\n"
             "  C            Clear trace\n"
             "  P            Save PNG\n"
+            "  Shift+P      Re-render trace to PNG (2x)\n"
+            "  G            Render full curve to PNG\n"
+            "  Shift+G      Sweep selected speed (11 PNGs)\n"
+            "  Ctrl+G       Animate selected speed (PNG frames, all cores)\n"
             "  M            Show/hide mechanism\n"
+            "  B            Mechanism motion blur\n"
+            "  K            Band-limit stages too fast to sample\n"
+            "  A            Allocation overlay\n"
+            "  N            Float / integer NCO evaluator\n"
+            "  L            Low-latency frame pacing\n"
+            "  3            Spherical 3-D mode\n"
+            "  V            Split view: full / zoom / mechanism\n"
+            "  Shift+V      Re-centre the zoom on the pen\n"
+            "  W            Stroke: constant / speed / curvature / nib\n"
+            "  O            Colour: path / speed / curvature / time / phase / winding\n"
+            "  D            Heatmap: samples / overdraw / off\n"
+            "  F            Post effects: off / glow / glow + vignette / soft / all (indexed canvas)\n"
             "  H / F1       Toggle this help\n"
             "\nPer-stage editing\n"
             "  PgUp / PgDn  Selected Stage +/-\n"
@@ -190,21 +122,44 @@ struct HelpOverlay {
     }
 };
 
-int main() {
-    constexpr unsigned kW = 1280, kH = 900;
+int main(int argc, char** argv) {
+    StartupProfile startup;
+    AppOptions opts;
+    if (!parseOptions(argc, argv, opts)) return 2;
+    startup.enabled = opts.startupProfile;
+    if (!opts.goldenDir.empty()) return runGolden(opts.goldenDir, opts.goldenUpdate, opts.goldenPerf);
+    if (opts.conformanceChains > 0) return runConformance(opts.conformanceChains, opts.seed);
+    if (opts.soak.seconds > 0.0) return runSoak(opts.soak);
+    if (!opts.animate.timeline.empty()) return runAnimation(opts.animate);
+    if (!opts.compose.sheet.empty()) return runSheet(opts.compose);
 
-    // --- trace resolution control ---
-    float maxPixelStep = 1.0f; // max pixels per sub-segment; lower = smoother
-    int   maxSubsteps = 256;  // safety cap
-    float lastT = 0.f;         // keep last time for sub-stepping
+    alloc::attachMainThread();
+    alloc::setEnabled(opts.allocTrack);
 
     // Anti-aliased window (MSAA)
     sf::ContextSettings settings; settings.antiAliasingLevel = 8;
-    sf::RenderWindow window(sf::VideoMode({ kW, kH }), "Nested Spirograph — per-stage speed (SFML 3)",
+    sf::RenderWindow window(sf::VideoMode({ kLogicalW, kLogicalH }), "Nested Spirograph — per-stage speed (SFML 3)",
         sf::State::Windowed, settings);
-    window.setFramerateLimit(120);
+    constexpr unsigned kFrameRate = 120;
+    window.setFramerateLimit(opts.lowLatency ? 0 : kFrameRate);
+    startup.mark("window");
 
-    const sf::Vector2f screenCenter = V2(kW * 0.5f, kH * 0.5f);
+    const sf::Vector2f screenCenter = V2(kLogicalW * 0.5f, kLogicalH * 0.5f);
+
+    // The figure lives in the fixed kLogicalW x kLogicalH space; a resized
+    // window shows it with a uniform scale (letterboxed), and the trace canvas
+    // is allocated at the window's real resolution.
+    auto fitScale = [&](sf::Vector2u px) {
+        return std::min(static_cast<float>(px.x) / kLogicalW, static_cast<float>(px.y) / kLogicalH);
+        };
+    auto worldView = [&](sf::Vector2u px, float scale) {
+        return sf::View(screenCenter, { px.x / scale, px.y / scale });
+        };
+    auto pixelView = [](sf::Vector2u px) {
+        return sf::View(sf::FloatRect({ 0.f, 0.f }, { static_cast<float>(px.x), static_cast<float>(px.y) }));
+        };
+    sf::Vector2u winSize{ kLogicalW, kLogicalH };
+    float viewScale = 1.f;
 
     // Base circle
     float R = 200.f;
@@ -217,45 +172,49 @@ int main() {
     big.setPointCount(220);
 
     // Stages (distinct speeds; negative reverses) — cleaner speeds + level=1..N
-    std::vector<Stage> chain;
-    {
-        float radius = R;
-        const float radiusDiv = 3.f;
-        const float baseSpeed = -4.00f; // rad/s
-        const float decay = 0.75f; // each level slower
-        const int   count = 10;
-
-        for (int i = 0; i < count; ++i) {
-            radius /= radiusDiv;
-            float s = pow(baseSpeed, i);
-            //float s = baseSpeed * std::pow(decay, static_cast<float>(i)) * ((i % 2) ? -1.f : 1.f);
-            chain.emplace_back(/*level*/ i + 1,
-                /*r*/ radius,
-                /*d*/ 0.f,               // set last stage's d below
-                /*outside*/ true,
-                /*speed*/ s);
-        }
-        if (!chain.empty()) {
-            // Give the last stage a real pen offset so we trace something non-trivial
-            chain.back().d = chain.back().r * 0.75f;
-        }
-    }
+    std::vector<Stage> chain = defaultChain(R);
 
-    // Trace surface
+    // Trace surface (traceSize/traceScale: what it was allocated for). The
+    // MSAA render texture is allocated after the first frame is on screen;
+    // until then there is nothing traced to show.
     sf::RenderTexture traceRT;
-    traceRT.resize({ kW, kH }, settings);
-    traceRT.setSmooth(true);
-    traceRT.clear(sf::Color::Transparent);
-    traceRT.display();
+    bool haveCanvas = false;
+    sf::Vector2u traceSize = winSize;
+    float traceScale = viewScale;
     sf::Sprite traceSprite(traceRT.getTexture());
 
+    // Optional palette-indexed CPU canvas (--indexed-canvas N) in place of
+    // traceRT. It has a fixed N canvas pixels per logical pixel and is shown
+    // scaled, so a resize needs no re-render.
+    const bool useIndexed = opts.indexedScale > 0;
+    if (!useIndexed && !opts.shareCanvas.empty()) std::cerr << "--share-canvas needs --indexed-canvas\n";
+    IndexedCanvas indexed;
+    sf::Texture indexedTex;
+    PostFx postFx;   // CPU glow / blur / vignette between the indexed canvas and its texture
+    std::optional<sf::Sprite> indexedSprite;
+
+    // Traced history, replayed into a new canvas after a resize. While that
+    // runs, the old canvas is shown scaled and keeps receiving live segments;
+    // the same segments are kept in liveSinceResize to lay over the rebuild.
+    std::vector<TraceRun> runs;
+    bool runOpen = false;
+    std::uint64_t chainVersion = 0, runVersion = 0;
+    TraceRebuilder rebuilder;
+    std::optional<sf::RenderTexture> rebuildRT;
+    std::vector<sf::Vertex> liveSinceResize;
+
+    // Exports and offline renders, a slice per frame (Esc cancels)
+    JobQueue jobs;
+    constexpr std::chrono::microseconds kJobSlice{ 4000 };
+    constexpr float kRenderScale = 2.f;         // PNG pixels per logical pixel
+    constexpr int kAnimationFrames = 240;       // Ctrl+G
+
     // HUD
     sf::Font font;
     bool haveFont =
-        font.openFromFile("assets/fonts/CONSOLA.TTF") ||
-        font.openFromFile("Consola.ttf") ||
-        font.openFromFile("consola.ttf") ||
-        font.openFromFile("arial.ttf");
+        font.openFromMemory(embeddedFontData(), embeddedFontSize()) ||
+        font.openFromFile("Assets/Fonts/CONSOLA.TTF");
+    startup.mark("font");
 
     std::optional<sf::Text> hud;
     if (haveFont) {
@@ -268,22 +227,79 @@ int main() {
     // Help
     HelpOverlay help;
     if (haveFont) help.init(font);
+    startup.mark("hud + help");
 
     // State
     bool tracing = true;
     bool showMechanism = true;
+    bool blurMechanism = false;
+    MechanismBlur mechBlur;
     int  sel = 0;    // selected stage
-    float t = 0.f;
+    double t = 0.0;   // simulated seconds; a float would stop advancing smoothly within days
     sf::Clock clock;
 
-    // Rainbow path control
-    float pathLen = 0.f;
-    float pixelsPerCycle = 600.f;
-    float hueOffset = 0.f;
-    float stroke = 2.f;  // use this global stroke for the thick segments
+    // Trace sub-sampling, rainbow and stroke settings + run state
+    Tracer tracer;
+
+    // Split view: every viewport draws from the same per-frame samples
+    bool splitView = false;
+    FrameSamples frame;
+    ZoomView zoomView;
+
+    // Sample-density / overdraw heatmap (debug), fed with the traced segments
+    Heatmap heatmap;
+    Heatmap::FrameTotals heatTotals;
+
+    // Spherical 3-D mode: its own point ring, re-projected every frame
+    bool mode3d = false;
+    Spiro3D spiro3d;
+    CompiledChain chain3d;
+    std::uint64_t chain3dVersion = ~std::uint64_t(0);
+    std::vector<sf::Vertex> verts3d;
+    float build3dMs = 0.f;
+
+    // Integer phase-accumulator evaluator, recompiled when the chain changes
+    bool useNco = opts.nco;
+    NcoChain ncoChain;
+    std::uint64_t ncoVersion = ~std::uint64_t(0);
+
+    // Optional shared-memory sample stream for external consumers
+    SampleStreamWriter sampleStream;
+    if (!opts.streamName.empty() && !sampleStream.open(opts.streamName, opts.streamCapacity))
+        std::cerr << "could not create sample stream '" << opts.streamName << "'\n";
+
+    // Optional local control socket (scripted parameter changes)
+    ControlSocket control;
+    if (!opts.controlPath.empty() && !control.listen(opts.controlPath))
+        std::cerr << "could not listen on control socket '" << opts.controlPath << "'\n";
+    std::vector<ControlBatch> batches;
+    float frameDt = 0.f;
+
+    // Allocation tracking: last frame's counts, optional CSV and budget
+    constexpr long kAllocWarmupFrames = 60;   // glyph pages, first-use caches
+    alloc::FrameAllocs lastAllocs;
+    long frameIndex = 0, framesOverBudget = 0;
+    std::ofstream allocCsv;
+    if (!opts.allocCsv.empty()) {
+        allocCsv.open(opts.allocCsv);
+        allocCsv << "frame";
+        for (std::size_t p = 0; p < alloc::kPhases; ++p) {
+            const char* n = alloc::phaseName(static_cast<alloc::Phase>(p));
+            allocCsv << ',' << n << "_allocs," << n << "_bytes";
+        }
+        allocCsv << ",total_allocs,total_bytes,total_frees\n";
+    }
+
+    // Key-to-present latency; low-latency mode replaces the frame-rate
+    // limiter's sleep after drawing with a just-in-time wait before polling
+    bool lowLatency = opts.lowLatency;
+    LatencyProbe latency;
+    FramePacer pacer(kFrameRate);
 
-    bool haveLast = false;
-    sf::Vector2f lastPen{};
+    // Flight recorder: always on, writes a report when a frame is slow
+    using FP = FlightRecorder::Phase;
+    FlightRecorder flight;
+    flight.configure(static_cast<std::size_t>(opts.flightFrames), opts.slowFrameMs, opts.flightDir);
 
     auto wrapIndex = [&](int i) {
         int n = static_cast<int>(chain.size());
@@ -299,28 +315,336 @@ int main() {
             << "Speed: " << std::fixed << std::setprecision(2) << chain[sel].speed << "\n"
             << "Size: " << std::fixed << std::setprecision(2) << chain[sel].r << "\n"
             << "Outside Roll: " << (chain[sel].outside ? "true" : "false") << "\n"
+            << "Evaluator: " << (useNco ? "NCO (integer)" : "float") << "\n"
+            << "Stroke: " << strokeModeName(tracer.calligraphy.mode) << "\n"
+            << "Colour: " << colorByName(tracer.color.by) << "\n"
+            << (blurMechanism ? "Motion blur: on\n" : "")
+            << (tracer.bandLimit ? "Band-limit: on\n" : "")
             << "H / F1 help\n";
+        if (rebuildRT)
+            ss << "Re-rendering " << static_cast<int>(rebuilder.progress() * 100.f) << "%\n";
+        if (const Job* job = jobs.current()) {
+            ss << job->label() << " " << static_cast<int>(job->progress() * 100.f) << "%"
+                << (job->cancelled() ? " (cancelling)" : " - Esc cancels");
+            if (jobs.queued() > 0) ss << ", " << jobs.queued() << " queued";
+            ss << "\n";
+        }
+        if (alloc::enabled()) {
+            const alloc::Counts tot = lastAllocs.total();
+            ss << "Alloc/frame: " << tot.allocs << " (" << std::fixed << std::setprecision(1)
+                << tot.bytes / 1024.0 << " KB)\n ";
+            for (std::size_t p = 0; p < alloc::kPhases; ++p)
+                ss << ' ' << alloc::phaseName(static_cast<alloc::Phase>(p)) << ' ' << lastAllocs.phase[p].allocs;
+            ss << "\n";
+            if (opts.allocBudget >= 0)
+                ss << "Over budget (" << opts.allocBudget << "): " << framesOverBudget << " frames\n";
+        }
+        if (useIndexed && haveCanvas) {
+            ss << "Canvas: " << std::fixed << std::setprecision(1) << indexed.bytes() / 1048576.0
+                << " MB indexed (RGBA " << indexed.rgbaBytes() / 1048576.0 << " MB)";
+            if (indexed.shared()) ss << ", shared as '" << opts.shareCanvas << "'";
+            ss << "\n";
+            if (postFx.active())
+                ss << "Post: " << PostFx::effectsName(postFx.effects()) << ", " << std::setprecision(2)
+                    << postFx.lastMs() << " ms / " << postFx.lastTiles() << " tiles\n" << std::setprecision(1);
+            if (const IndexedCanvas::TileStats ts = indexed.tileStats(); ts.cold > 0)
+                ss << "Cold tiles: " << ts.cold << " packed to " << ts.packedBytes / 1024.0 << " KB (raw "
+                    << ts.coldRawBytes / 1024.0 << " KB), " << ts.hot << " live\n";
+        }
+        if (const LatencyProbe::Stats ls = latency.stats(lowLatency); ls.count > 0)
+            ss << "Key latency: " << std::fixed << std::setprecision(1) << ls.p50Ms << " ms p50, "
+                << ls.p95Ms << " p95 (" << ls.worstP50Ms << " with queue wait)\n";
+        if (mode3d)
+            ss << "3-D: " << spiro3d.segments() << " segments (keeps " << spiro3d.capacity() << "), "
+                << std::fixed << std::setprecision(1) << build3dMs << " ms to project\n";
+        if (heatmap.mode != Heatmap::Mode::Off) {
+            const double od = heatTotals.pixels ? static_cast<double>(heatTotals.writes) / heatTotals.pixels : 0.0;
+            ss << "Heatmap (" << Heatmap::modeName(heatmap.mode) << "): " << heatTotals.samples << " samples, "
+                << heatTotals.writes << " px writes on " << heatTotals.pixels << " px (" << std::fixed
+                << std::setprecision(1) << od << "x) this frame, peak " << heatTotals.peak << "\n";
+        }
+        if (lowLatency) ss << "Low-latency pacing: on (frame ~" << pacer.expectedWorkMs() << " ms)\n";
+        if (flight.reports() > 0)
+            ss << "Slow-frame reports: " << flight.reports() << "\n";
         hud->setString(ss.str());
         };
     updateHud();
 
+    // Makes the canvas current for the window: either adopts a finished
+    // rebuild, or (rebuild abandoned / nothing to keep) starts empty.
+    auto adoptCanvas = [&](bool keepRebuild) {
+        rebuilder.cancel();
+        traceSize = winSize;
+        traceScale = viewScale;
+        traceRT.resize(traceSize, settings);
+        traceRT.setSmooth(true);
+        traceRT.setView(worldView(traceSize, traceScale));
+        traceRT.clear(sf::Color::Transparent);
+        if (keepRebuild && rebuildRT) {
+            flight.flag(FlightRecorder::RebuildSwap);
+            rebuildRT->display();
+            sf::Sprite copy(rebuildRT->getTexture());
+            traceRT.setView(pixelView(traceSize));
+            traceRT.draw(copy, sf::RenderStates(sf::BlendNone));
+            traceRT.setView(worldView(traceSize, traceScale));
+        }
+        traceRT.display();
+        traceSprite.setTexture(traceRT.getTexture(), true);
+        haveCanvas = true;
+        rebuildRT.reset();
+        liveSinceResize.clear();
+        };
+
+    auto startRebuild = [&] {
+        rebuilder.cancel();
+        rebuildRT.emplace();
+        rebuildRT->resize(winSize, settings);
+        rebuildRT->setSmooth(true);
+        rebuildRT->setView(worldView(winSize, viewScale));
+        rebuildRT->clear(sf::Color::Transparent);
+        liveSinceResize.clear();
+
+        TraceStyle style;
+        style.center = screenCenter;
+        style.stroke = tracer.stroke;
+        style.maxPixelStep = tracer.maxPixelStep / viewScale;
+        style.maxSubsteps = tracer.maxSubsteps;
+        style.pixelsPerCycle = tracer.pixelsPerCycle;
+        style.hueOffset = tracer.hueOffset;
+        style.color = tracer.color;
+        style.calligraphy = tracer.calligraphy;
+        rebuilder.start(runs, style);
+        };
+
+    auto clearTrace = [&] {
+        runs.clear(); runOpen = false;
+        if (useIndexed) indexed.clear();
+        else adoptCanvas(false);
+        tracer.clear();
+        spiro3d.clear();
+        zoomView.clear();
+        if (heatmap.ready()) heatmap.clear();
+        };
+
+    auto numbered = [](const char* prefix, int& n, const char* ext) {
+        std::ostringstream name;
+        name << prefix << std::setw(3) << std::setfill('0') << n++ << ext;
+        return name.str();
+        };
+
+    // indexed: a LUT pass on the CPU instead of a GPU read-back
+    auto captureCanvas = [&] {
+        flight.flag(FlightRecorder::Snapshot);
+        return useIndexed ? indexed.toImage() : traceRT.getTexture().copyToImage();
+        };
+
+    // Synchronous (the control socket replies with the path); P goes through a job.
+    int snapshotNo = 0;
+    auto saveSnapshot = [&](std::string path) {
+        if (path.empty()) path = numbered("nested_pss_", snapshotNo, ".png");
+        if (!haveCanvas) return std::string();
+        return captureCanvas().saveToFile(path) ? path : std::string();
+        };
+
+    auto renderStyle = [&](float pixelStep) {
+        TraceStyle style;
+        style.center = screenCenter;
+        style.stroke = tracer.stroke;
+        style.maxPixelStep = pixelStep;   // PNG pixels
+        style.maxSubsteps = tracer.maxSubsteps;
+        style.pixelsPerCycle = tracer.pixelsPerCycle;
+        style.hueOffset = tracer.hueOffset;
+        style.color = tracer.color;
+        style.calligraphy = tracer.calligraphy;
+        return style;
+        };
+    const sf::Vector2u renderSize{ static_cast<unsigned>(kLogicalW * kRenderScale), static_cast<unsigned>(kLogicalH * kRenderScale) };
+
+    // One period of the chain (t = 0..T) from the start of the rainbow.
+    auto fullCurve = [&](const std::vector<Stage>& c, std::string path) {
+        CompiledChain compiled = compileChain(R, c);
+        const double period = curvePeriod(compiled, kMaxCurveSeconds);
+        return CurveImage{ { TraceRun{ std::move(compiled), 0.0, period, 0.f } }, std::move(path) };
+        };
+
+    auto submitCurve = [&] {
+        static int n = 0;
+        std::vector<CurveImage> images;
+        images.push_back(fullCurve(chain, numbered("nested_curve_", n, ".png")));
+        jobs.submit(std::make_unique<CurveRenderJob>("Full curve", std::move(images), renderSize, kRenderScale, renderStyle(tracer.maxPixelStep)));
+        };
+
+    // Selected stage's speed -0.5 .. +0.5 around its value, one PNG each.
+    auto submitSweep = [&] {
+        static int n = 0;
+        const std::string prefix = numbered("nested_sweep_", n, "_");
+        std::vector<CurveImage> images;
+        for (int i = -5; i <= 5; ++i) {
+            std::vector<Stage> c = chain;
+            c[sel].speed += 0.1f * i;
+            std::ostringstream name;
+            name << prefix << std::setw(2) << std::setfill('0') << i + 5 << ".png";
+            images.push_back(fullCurve(c, name.str()));
+        }
+        jobs.submit(std::make_unique<CurveRenderJob>("Speed sweep", std::move(images), renderSize, kRenderScale, renderStyle(tracer.maxPixelStep)));
+        };
+
+    // The same sweep as a continuous animation: one frame per step of
+    // kAnimationFrames, rendered on every core but one (the window keeps it).
+    auto submitAnimation = [&] {
+        static int n = 0;
+        Timeline timeline;
+        timeline.frames = kAnimationFrames;
+        timeline.tracks.push_back({ Track::Param::Speed, sel, { { 0.0, chain[sel].speed - 0.5f }, { 1.0, chain[sel].speed + 0.5f } } });
+        const unsigned cores = std::thread::hardware_concurrency();
+        jobs.submit(std::make_unique<AnimationJob>(numbered("nested_anim_", n, "_"), R, chain, std::move(timeline),
+            renderSize, kRenderScale, renderStyle(tracer.maxPixelStep), kMaxCurveSeconds, cores > 1 ? cores - 1 : 1));
+        };
+
+    // The traced history again at kRenderScale with half-pixel steps.
+    auto submitRefined = [&] {
+        static int n = 0;
+        if (runs.empty()) return;
+        std::vector<CurveImage> images;
+        images.push_back({ runs, numbered("nested_refined_", n, ".png") });
+        jobs.submit(std::make_unique<CurveRenderJob>("Refined trace", std::move(images), renderSize, kRenderScale, renderStyle(0.5f)));
+        };
+
+    auto exportChain = [&](std::string path) {
+        if (path.empty()) {
+            static int n = 0; std::ostringstream name;
+            name << "nested_chain_" << std::setw(3) << std::setfill('0') << n++ << ".txt";
+            path = name.str();
+        }
+        flight.flag(FlightRecorder::Export);
+        std::ofstream out(path);
+        writeChain(out, R, chain);
+        return out ? path : std::string();
+        };
+
+    // Applies one control batch all-or-nothing. Every op is checked against the
+    // current chain first; only then is anything written. Returns the reply.
+    auto applyBatch = [&](const ControlBatch& b) -> std::string {
+        using K = ControlOp::Kind;
+        using F = ControlOp::Field;
+        if (!b.error.empty()) return "err " + b.error;
+
+        for (const ControlOp& op : b.ops) {
+            if (!std::isfinite(op.value)) return "err value not finite";
+            if (op.kind == K::SetStage) {
+                if (op.level < 1 || op.level > static_cast<int>(chain.size())) return "err no stage " + std::to_string(op.level);
+                if (op.field == F::R && op.value <= 0.0) return "err r must be > 0";
+            }
+            if (op.kind == K::SetBase && op.value < 20.0) return "err R must be >= 20";
+        }
+
+        std::string reply = "ok " + std::to_string(b.ops.size());
+        for (const ControlOp& op : b.ops) {
+            const float v = static_cast<float>(op.value);
+            switch (op.kind) {
+            case K::SetStage: {
+                Stage& s = chain[op.level - 1];
+                switch (op.field) {
+                case F::Speed:   s.speed = v; break;
+                case F::R:       s.r = v; s.syncDisc(); break;
+                case F::D:       s.d = v; break;
+                case F::Phase:   s.phase = v; break;
+                case F::Outside: s.outside = (op.value != 0.0); break;
+                }
+                ++chainVersion;
+                break;
+            }
+            case K::SetBase:
+                R = v; big.setRadius(R); big.setOrigin({ R,R }); ++chainVersion; break;
+            case K::Clear:
+                clearTrace(); break;
+            case K::Snapshot: {
+                const std::string path = saveSnapshot(op.path);
+                reply += path.empty() ? " snapshot-failed" : " " + path;
+                break;
+            }
+            case K::Export: {
+                const std::string path = exportChain(op.path);
+                reply += path.empty() ? " export-failed" : " " + path;
+                break;
+            }
+            case K::Stats: {
+                std::ostringstream ss;
+                ss << " t=" << t << " pathLen=" << tracer.pathLen << " stages=" << chain.size()
+                    << " R=" << R << " fps=" << (frameDt > 0.f ? 1.f / frameDt : 0.f)
+                    << " tracing=" << (tracing ? 1 : 0);
+                reply += ss.str();
+                break;
+            }
+            }
+        }
+        return reply;
+        };
+
+    startup.mark("app state");
+
     while (window.isOpen()) {
+        flight.beginFrame(frameIndex);
+        const std::uint64_t frameChainVersion = chainVersion;
+        if (lowLatency) {
+            flight.phase(FP::Present);   // the limiter's sleep, moved to the front
+            pacer.waitForSlot();
+            flight.phase(FP::Events);
+        }
+
+        if (!haveCanvas && frameIndex > 0) {
+            if (useIndexed) {
+                const float n = static_cast<float>(opts.indexedScale);
+                // a shared canvas gets its new region from resize; share() the first time
+                bool shareOk = indexed.resize({ kLogicalW * opts.indexedScale, kLogicalH * opts.indexedScale }, screenCenter, n);
+                if (!indexedTex.resize(indexed.size())) std::cerr << "indexed canvas too large for a texture\n";
+                if (shareOk && !opts.shareCanvas.empty() && !indexed.shared()) shareOk = indexed.share(opts.shareCanvas);
+                if (!shareOk)
+                    std::cerr << "could not share the canvas as '" << opts.shareCanvas << "' (retrying)\n";
+                indexedTex.setSmooth(true);
+                indexedSprite.emplace(indexedTex);
+                haveCanvas = true;
+            }
+            else {
+                adoptCanvas(false);
+            }
+            startup.mark("trace canvas (lazy)");
+            if (startup.enabled) startup.report(std::cout);
+        }
+
         // ----- events -----
+        alloc::setPhase(alloc::Phase::Events);
+        latency.beginPoll();
         while (const auto ev = window.pollEvent()) {
             if (ev->is<sf::Event::Closed>()) { window.close(); continue; }
 
+            if (const auto* rs = ev->getIf<sf::Event::Resized>()) {
+                if (rs->size.x == 0 || rs->size.y == 0) continue;   // minimised
+                flight.flag(FlightRecorder::Resize);
+                winSize = rs->size;
+                viewScale = fitScale(winSize);
+                if (useIndexed) {}             // fixed-size canvas, just shown scaled
+                else if (runs.empty()) adoptCanvas(false);
+                else startRebuild();
+                updateHud();
+                continue;
+            }
+
             if (const auto* k = ev->getIf<sf::Event::KeyPressed>()) {
                 using KS = sf::Keyboard::Scancode;
+                latency.input();
 
                 switch (k->scancode) {
                     // app control
-                case KS::Escape:   window.close(); break;
+                case KS::Escape:
+                    if (jobs.busy()) { jobs.cancelAll(); updateHud(); }
+                    else window.close();
+                    break;
                 case KS::Space:    tracing = !tracing; break;
                 case KS::M:        showMechanism = !showMechanism; break;
-                case KS::C:
-                    traceRT.clear(sf::Color::Transparent); traceRT.display();
-                    haveLast = false; pathLen = 0.f;
-                    break;
+                case KS::B:        blurMechanism = !blurMechanism; updateHud(); break;
+                case KS::K:        tracer.bandLimit = !tracer.bandLimit; updateHud(); break;
+                case KS::C:        clearTrace(); break;
 
                     // selection via PageUp/PageDown
                 case KS::PageUp:
@@ -330,16 +654,89 @@ int main() {
 
                     // toggle inside/outside on selected stage
                 case KS::E:
-                    chain[sel].outside = !chain[sel].outside; updateHud(); break;
+                    chain[sel].outside = !chain[sel].outside; ++chainVersion; updateHud(); break;
 
                     // save PNG
-                case KS::P: {
-                    auto img = traceRT.getTexture().copyToImage();
-                    static int n = 0; std::ostringstream name;
-                    name << "nested_pss_" << std::setw(3) << std::setfill('0') << n++ << ".png";
-                    img.saveToFile(name.str());
+                case KS::P:
+                    if (k->shift) submitRefined();
+                    else if (haveCanvas)
+                        jobs.submit(std::make_unique<SaveImageJob>(captureCanvas(), numbered("nested_pss_", snapshotNo, ".png")));
+                    updateHud(); break;
+
+                    // offline renders of the whole curve
+                case KS::G:
+                    if (k->control) submitAnimation();
+                    else if (k->shift) submitSweep();
+                    else submitCurve();
+                    updateHud(); break;
+
+                    // allocation overlay
+                case KS::A:
+                    alloc::setEnabled(!alloc::enabled()); alloc::endFrame(); updateHud(); break;
+
+                    // float / NCO evaluator
+                case KS::N:
+                    useNco = !useNco; updateHud(); break;
+
+                    // side-by-side viewports
+                case KS::V:
+                    if (k->shift) { if (splitView) zoomView.recenter(frame.pen, settings); }
+                    else {
+                        splitView = !splitView;
+                        if (splitView) zoomView.recenter(frame.pen, settings);
+                    }
                     break;
-                }
+
+                    // spherical 3-D view (the 2-D canvas keeps what it has)
+                case KS::Num3:
+                    mode3d = !mode3d;
+                    spiro3d.stroke = tracer.stroke;
+                    spiro3d.pixelsPerCycle = tracer.pixelsPerCycle;
+                    spiro3d.hueOffset = tracer.hueOffset;
+                    updateHud(); break;
+
+                    // just-in-time pacing vs frame-rate limiter
+                case KS::L:
+                    lowLatency = !lowLatency;
+                    window.setFramerateLimit(lowLatency ? 0 : kFrameRate);
+                    pacer.setRate(kFrameRate);
+                    updateHud(); break;
+
+                    // heatmap debug view: samples -> overdraw -> off
+                case KS::D:
+                    heatmap.mode = static_cast<Heatmap::Mode>(
+                        (static_cast<int>(heatmap.mode) + 1) % static_cast<int>(Heatmap::Mode::Count));
+                    if (heatmap.mode != Heatmap::Mode::Off && !heatmap.ready()
+                        && !heatmap.resize({ kLogicalW, kLogicalH }, screenCenter - V2(kLogicalW * 0.5f, kLogicalH * 0.5f))) {
+                        std::cerr << "heatmap: could not create its texture\n";
+                        heatmap.mode = Heatmap::Mode::Off;
+                    }
+                    updateHud(); break;
+
+                    // calligraphic stroke width
+                case KS::W:
+                    tracer.calligraphy.mode = static_cast<StrokeMode>(
+                        (static_cast<int>(tracer.calligraphy.mode) + 1) % static_cast<int>(StrokeMode::Count));
+                    updateHud(); break;
+
+                    // colour by path length or pen motion
+                case KS::O:
+                    tracer.color.by = static_cast<ColorBy>(
+                        (static_cast<int>(tracer.color.by) + 1) % static_cast<int>(ColorBy::Count));
+                    updateHud(); break;
+
+                    // CPU post effects on the indexed canvas
+                case KS::F:
+                    if (!useIndexed) break;
+                    {
+                        static const unsigned presets[] = { 0, PostFx::Glow, PostFx::Glow | PostFx::Vignette,
+                            PostFx::Soft, PostFx::Glow | PostFx::Soft | PostFx::Vignette };
+                        const auto* cur = std::find(std::begin(presets), std::end(presets), postFx.effects());
+                        const auto next = cur == std::end(presets) ? 0 : (cur - presets + 1) % std::size(presets);
+                        postFx.setEffects(presets[next]);
+                        if (!postFx.active()) indexed.markAllDirty();   // back to the plain upload
+                    }
+                    updateHud(); break;
 
                           // help
                 case KS::H:
@@ -349,78 +746,132 @@ int main() {
 
                     // base radius
                 case KS::Up:
-                    R += 5.f; big.setRadius(R); big.setOrigin({ R,R }); updateHud(); break;
+                    R += 5.f; big.setRadius(R); big.setOrigin({ R,R }); ++chainVersion; updateHud(); break;
                 case KS::Down:
-                    R = std::max(20.f, R - 5.f); big.setRadius(R); big.setOrigin({ R,R }); updateHud(); break;
+                    R = std::max(20.f, R - 5.f); big.setRadius(R); big.setOrigin({ R,R }); ++chainVersion; updateHud(); break;
 
                     // per-stage speed (correct bracket names in SFML 3)
-                case KS::LBracket:  chain[sel].speed -= 0.1f; updateHud(); break; // [
-                case KS::RBracket:  chain[sel].speed += 0.1f; updateHud(); break; // ]
-                case KS::Z:         chain[sel].speed = -chain[sel].speed; updateHud(); break;
+                case KS::LBracket:  chain[sel].speed -= 0.1f; ++chainVersion; updateHud(); break; // [
+                case KS::RBracket:  chain[sel].speed += 0.1f; ++chainVersion; updateHud(); break; // ]
+                case KS::Z:         chain[sel].speed = -chain[sel].speed; ++chainVersion; updateHud(); break;
 
                 default: break;
                 }
             }
         }
 
+        // ----- control socket: whole batches between frames -----
+        flight.phase(FP::Control);
+        if (control.isOpen()) {
+            batches.clear();
+            control.poll(batches);
+            for (const ControlBatch& b : batches) control.reply(b.client, applyBatch(b));
+            if (!batches.empty()) updateHud();   // once per frame, not per command
+        }
+
         // ----- update -----
+        alloc::setPhase(alloc::Phase::Update);
+        flight.phase(FP::Update);
         float dt = clock.restart().asSeconds();
+        frameDt = dt;
         if (!help.visible) { // pause sim while help is visible (optional)
             t += dt;
         }
 
-        // centers & pen
-        std::vector<sf::Vector2f> centers;
-        sf::Vector2f penLocal = nestedPenAndCenters_perStageSpeed(R, chain, t, &centers);
+        // centers & pen, once per frame for every view
+        frame.clearSegments();
+        const sf::Vector2f penLocal = nestedPenAndCenters_perStageSpeed(R, chain, t, &frame.centers);
+        const std::vector<sf::Vector2f>& centers = frame.centers;
         sf::Vector2f penPos = screenCenter + penLocal;
+        frame.pen = penPos;
 
         // ======== trace (adaptive sub-sampling) ========
-        if (tracing && !help.visible) {
-            // where we *want* to be this frame
-            const sf::Vector2f currPen = screenCenter + penAtTime(R, chain, t);
-
-            if (!haveLast) {
-                // first point in a run
-                haveLast = true;
-                lastPen = currPen;
-                lastT = t;
-            }
-
-            // Decide how many sub-steps based on screen distance
-            const float dist = std::hypot(currPen.x - lastPen.x, currPen.y - lastPen.y);
-            int steps = static_cast<int>(std::ceil(dist / std::max(0.1f, maxPixelStep)));
-            steps = std::clamp(steps, 1, maxSubsteps);
-
-            sf::Vector2f prev = lastPen;
-
-            for (int i = 1; i <= steps; ++i) {
-                float s = static_cast<float>(i) / static_cast<float>(steps);
-                float ti = lastT + (t - lastT) * s;
-
-                sf::Vector2f p = screenCenter + penAtTime(R, chain, ti);
-
-                // rainbow by length (small segments, smooth gradient)
-                float prevLen = pathLen;
-                pathLen += std::hypot(p.x - prev.x, p.y - prev.y);
-
-                float h0 = std::fmod((prevLen / pixelsPerCycle) * 360.f + hueOffset, 360.f);
-                float h1 = std::fmod((pathLen / pixelsPerCycle) * 360.f + hueOffset, 360.f);
-                sf::Color c0 = hsv(h0, 1.f, 1.f);
-                sf::Color c1 = hsv(h1, 1.f, 1.f);
-
-                // USE THE GLOBAL stroke (tweak #2)
-                drawThickSegment(traceRT, prev, p, stroke, c0, c1);
+        alloc::setPhase(alloc::Phase::Trace);
+        flight.phase(FP::Trace);
+        if (mode3d && chain3dVersion != chainVersion) {
+            chain3d = compileChain(R, chain);
+            chain3dVersion = chainVersion;
+        }
+        if (mode3d && tracing && !help.visible) {
+            flight.addSamples(static_cast<std::uint32_t>(spiro3d.trace(chain3d, t)));
+        }
+        else {
+            spiro3d.stop();
+        }
 
-                prev = p;
+        if (tracing && !help.visible && haveCanvas && !mode3d) {
+            // history for re-rendering: a new run whenever the chain changed
+            const double runFrom = tracer.haveLast ? tracer.lastT : t;
+            if (!runOpen || runVersion != chainVersion) {
+                runs.push_back({ compileChain(R, chain), runFrom, t, tracer.pathLen });
+                runOpen = true;
+                runVersion = chainVersion;
+            }
+            else {
+                runs.back().t1 = t;
             }
 
-            // finalize for next frame
-            lastPen = currPen;
-            lastT = t;
-            traceRT.display();
+            if (useNco && ncoVersion != chainVersion) {
+                ncoChain = compileNco(runs.back().chain);
+                ncoVersion = chainVersion;
+            }
+            tracer.nco = useNco ? &ncoChain : nullptr;
+            tracer.compiled = &runs.back().chain;   // for calligraphic widths and motion colours; valid for this call
+
+            auto onSegment = [&](double ti, sf::Vector2f p0, sf::Vector2f p1, sf::Color c0, sf::Color c1) {
+                sampleStream.publish(ti, p1.x, p1.y, c1.toInteger());
+                if (rebuildRT) appendThickSegment(liveSinceResize, p0, p1, tracer.stroke, c0, c1);
+                frame.segments.push_back({ p0, p1, c0, c1 });
+                if (heatmap.mode != Heatmap::Mode::Off) heatmap.segment(p0, p1, tracer.stroke);
+                };
+            int steps = 0;
+            if (useIndexed) {
+                steps = tracer.advance(indexed, R, chain, screenCenter, t, indexed.scale(), onSegment);
+            }
+            else {
+                steps = tracer.advance(traceRT, R, chain, screenCenter, t, viewScale, onSegment);
+                flight.addDrawCalls(static_cast<std::uint32_t>(tracer.batchedDraw() ? 1 : steps * kThickSegmentDrawCalls));
+                traceRT.display();
+            }
+            flight.addSamples(static_cast<std::uint32_t>(steps));
+            if (splitView) zoomView.consume(frame, tracer.stroke);
+            if (steps >= tracer.maxSubsteps) flight.flag(FlightRecorder::SubstepCap);
         }
         else {
-            haveLast = false; // stop the run
+            tracer.stop(); // stop the run
+            runOpen = false;
+        }
+        if (useIndexed && haveCanvas) {
+            // texture updates; with post effects every tile a change reaches
+            const int uploaded = postFx.active() ? postFx.upload(indexed, indexedTex) : indexed.upload(indexedTex);
+            flight.addDrawCalls(static_cast<std::uint32_t>(uploaded));
+            if (postFx.active() && uploaded > 0 && frameIndex % 15 == 0) updateHud();
+            if (opts.coldTileFrames > 0 && indexed.compressCold(opts.coldTileFrames) > 0) updateHud();
+            indexed.publish();   // shared canvas: this frame's tiles to the viewers
+        }
+        if (heatmap.mode != Heatmap::Mode::Off) {
+            heatTotals = heatmap.endFrame();
+            if (frameIndex % 15 == 0) updateHud();
+        }
+
+        // background re-render: draw what is ready, swap in when complete
+        flight.phase(FP::Rebuild);
+        if (rebuildRT) {
+            const sf::RenderStates states;
+            if (rebuilder.pump(*rebuildRT, states, 400000)) {
+                if (!liveSinceResize.empty())
+                    rebuildRT->draw(liveSinceResize.data(), liveSinceResize.size(), sf::PrimitiveType::Triangles);
+                adoptCanvas(true);
+            }
+            updateHud();
+        }
+
+        // jobs: a bounded slice of this frame
+        flight.phase(FP::Jobs);
+        if (jobs.busy()) {
+            const std::string done = jobs.pump(kJobSlice);
+            if (!done.empty()) std::cout << done << "\n";
+            updateHud();
         }
 
         // Update small disc positions once per frame (draw later)
@@ -429,41 +880,176 @@ int main() {
         }
 
         // ----- draw -----
+        if (frameIndex == 0) startup.mark("first frame: events..trace");
+        alloc::setPhase(alloc::Phase::Draw);
+        flight.phase(FP::Draw);
+        std::uint32_t drawCalls = 0;
+        auto draw = [&](const auto&... args) { window.draw(args...); ++drawCalls; };
         window.clear(sf::Color(15, 18, 22));
-        window.draw(traceSprite);
-        window.draw(big);
-
-        if (showMechanism) {
-            for (std::size_t i = 0; i < chain.size(); ++i) {
-                // highlight selected
-                chain[i].disc.setOutlineColor(i == static_cast<std::size_t>(sel)
-                    ? sf::Color(255, 230, 120)
-                    : sf::Color(140, 200, 255));
-                window.draw(chain[i].disc);
-
-                sf::Vector2f from = screenCenter + centers[i];
-                sf::Vector2f to = (i + 1 < centers.size())
-                    ? (screenCenter + centers[i + 1])
-                    : penPos;
-                sf::Vertex arm[2] = {
-                    sf::Vertex{ from, sf::Color(120,200,140) },
-                    sf::Vertex{ to,   sf::Color(120,200,140) }
-                };
-                window.draw(arm, 2, sf::PrimitiveType::Lines);
-            }
-        }
 
-        // pen dot
+        // pen dot (positioned per view)
         sf::CircleShape penDot(4.f);
         penDot.setOrigin({ 4.f, 4.f });
         penDot.setFillColor(sf::Color::Red);
-        penDot.setPosition(penPos);
-        window.draw(penDot);
 
-        if (hud)  window.draw(*hud);
+        auto drawMechanism = [&] {
+            if (showMechanism && blurMechanism) {
+                // shutter over the last frame; nothing moves while paused
+                mechBlur.build(R, chain, screenCenter, t, help.visible ? 0.f : frameDt, sel);
+                draw(mechBlur.verts.data(), mechBlur.verts.size(), sf::PrimitiveType::Triangles);
+            }
+            else if (showMechanism) {
+                for (std::size_t i = 0; i < chain.size(); ++i) {
+                    // highlight selected
+                    chain[i].disc.setOutlineColor(i == static_cast<std::size_t>(sel)
+                        ? sf::Color(255, 230, 120)
+                        : sf::Color(140, 200, 255));
+                    draw(chain[i].disc);
+
+                    sf::Vector2f from = screenCenter + centers[i];
+                    sf::Vector2f to = (i + 1 < centers.size())
+                        ? (screenCenter + centers[i + 1])
+                        : penPos;
+                    sf::Vertex arm[2] = {
+                        sf::Vertex{ from, sf::Color(120,200,140) },
+                        sf::Vertex{ to,   sf::Color(120,200,140) }
+                    };
+                    draw(arm, 2, sf::PrimitiveType::Lines);
+                }
+            }
+            };
+
+        if (splitView && !mode3d) {
+            // full figure | zoomed detail | mechanism only, all from this frame's samples
+            const float w3 = winSize.x / 3.f, h = static_cast<float>(winSize.y);
+            const sf::Vector2f logical{ static_cast<float>(kLogicalW), static_cast<float>(kLogicalH) };
+            penDot.setPosition(penPos);
+
+            window.setView(fitView(screenCenter, logical, { { 0.f, 0.f }, { w3, h } }, winSize));
+            if (indexedSprite) {
+                indexedSprite->setOrigin({ indexed.size().x * 0.5f, indexed.size().y * 0.5f });
+                indexedSprite->setPosition(screenCenter);
+                indexedSprite->setScale({ 1.f / indexed.scale(), 1.f / indexed.scale() });
+                draw(*indexedSprite);
+            }
+            else if (haveCanvas) {
+                traceSprite.setOrigin({ traceSize.x * 0.5f, traceSize.y * 0.5f });
+                traceSprite.setPosition(screenCenter);
+                traceSprite.setScale({ 1.f / traceScale, 1.f / traceScale });
+                draw(traceSprite);
+            }
+            if (heatmap.mode != Heatmap::Mode::Off) { heatmap.refresh(); draw(heatmap.sprite()); }
+            draw(big);
+            draw(penDot);
+
+            const float zw = zoomView.worldSize();
+            window.setView(fitView(zoomView.focus(), { zw, zw }, { { w3, 0.f }, { w3, h } }, winSize));
+            if (zoomView.ready()) draw(zoomView.sprite());
+            draw(penDot);
+
+            window.setView(fitView(screenCenter, logical, { { 2.f * w3, 0.f }, { w3, h } }, winSize));
+            draw(big);
+            drawMechanism();
+            draw(penDot);
+        }
+        else {
+            // canvas in window pixels; scaled only while a re-render is pending
+            window.setView(pixelView(winSize));
+            traceSprite.setOrigin({ traceSize.x * 0.5f, traceSize.y * 0.5f });
+            traceSprite.setPosition({ winSize.x * 0.5f, winSize.y * 0.5f });
+            traceSprite.setScale({ viewScale / traceScale, viewScale / traceScale });
+            if (mode3d) {}                 // the sphere replaces the canvas
+            else if (indexedSprite) {
+                const float k = viewScale / indexed.scale();
+                indexedSprite->setOrigin({ indexed.size().x * 0.5f, indexed.size().y * 0.5f });
+                indexedSprite->setPosition({ winSize.x * 0.5f, winSize.y * 0.5f });
+                indexedSprite->setScale({ k, k });
+                draw(*indexedSprite);
+            }
+            else if (haveCanvas) {
+                draw(traceSprite);
+            }
+
+            window.setView(worldView(winSize, viewScale));
+            if (!mode3d && heatmap.mode != Heatmap::Mode::Off) { heatmap.refresh(); draw(heatmap.sprite()); }
+            if (!mode3d) draw(big);
+
+            if (mode3d) {
+                // all kept segments, rotated and depth-sorted: one draw call
+                const auto t0 = std::chrono::steady_clock::now();
+                spiro3d.build(screenCenter, t, verts3d);
+                build3dMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                if (!verts3d.empty()) draw(verts3d.data(), verts3d.size(), sf::PrimitiveType::Triangles);
+                penPos = spiro3d.project(chain3d, penLocal, screenCenter, t);
+                if (frameIndex % 30 == 0) updateHud();
+            }
+            else {
+                drawMechanism();
+            }
+
+            penDot.setPosition(penPos);
+            draw(penDot);
+        }
+
+        window.setView(pixelView(winSize));
+        if (hud)  draw(*hud);
         help.draw(window);            // draw help overlay LAST
+        if (help.visible) drawCalls += 2;
+        flight.addDrawCalls(drawCalls);
+        flight.phase(FP::Present);     // includes the frame-rate limiter's sleep
+        if (frameIndex == 0) startup.mark("first frame: draw");
         window.display();
+        if (frameIndex == 0) startup.firstFramePresented();
+        if (lowLatency) pacer.presented();
+        if (latency.presented(lowLatency)) updateHud();
+
+        // ----- per-frame allocation accounting -----
+        if (alloc::enabled()) {
+            lastAllocs = alloc::endFrame();
+            const alloc::Counts tot = lastAllocs.total();
+            const std::uint64_t hudAllocs = lastAllocs.phase[static_cast<std::size_t>(alloc::Phase::Hud)].allocs;
+            if (opts.allocBudget >= 0 && frameIndex >= kAllocWarmupFrames
+                && tot.allocs - hudAllocs > static_cast<std::uint64_t>(opts.allocBudget))
+                ++framesOverBudget;
+            if (allocCsv) {
+                allocCsv << frameIndex;
+                for (const alloc::Counts& c : lastAllocs.phase) allocCsv << ',' << c.allocs << ',' << c.bytes;
+                allocCsv << ',' << tot.allocs << ',' << tot.bytes << ',' << tot.frees << '\n';
+            }
+            flight.setAllocs(tot.allocs, tot.bytes);
+            // The readout refreshes a few times a second, billed to its own
+            // phase (next frame's); a per-frame HUD rebuild would be the very
+            // churn it reports.
+            if (frameIndex % 30 == 0) {
+                alloc::setPhase(alloc::Phase::Hud);
+                updateHud();
+            }
+        }
+        if (chainVersion != frameChainVersion) flight.flag(FlightRecorder::Edit);
+        const std::string report = flight.endFrame();
+        if (!report.empty()) {
+            std::cerr << "slow frame: wrote " << report << "\n";
+            updateHud();
+        }
+        ++frameIndex;
+        if (opts.maxFrames > 0 && frameIndex >= opts.maxFrames) window.close();
     }
 
+    if (startup.enabled && !haveCanvas) startup.report(std::cout);   // quit before frame 1
+
+    for (const bool low : { false, true }) {
+        const LatencyProbe::Stats ls = latency.stats(low);
+        if (ls.count == 0) continue;
+        std::cout << "key latency (" << (low ? "low-latency" : "frame limiter") << ", " << ls.count << " keys): "
+            << std::fixed << std::setprecision(1) << ls.p50Ms << " ms p50, " << ls.p95Ms << " ms p95, "
+            << ls.worstP50Ms << " ms p50 with queue wait\n";
+    }
+
+    if (opts.allocBudget >= 0) {
+        std::cout << "allocation budget " << opts.allocBudget << "/frame: "
+            << framesOverBudget << " of " << std::max(0L, frameIndex - kAllocWarmupFrames)
+            << " frames over\n";
+        if (framesOverBudget > 0) return 3;
+    }
     return 0;
 }
@@ -0,0 +1,88 @@
+// CanvasViewer.cpp — mirrors the app's shared indexed canvas (--share-canvas NAME)
+// by copying only the tiles that changed, and reports generations / tiles /
+// bytes per second. Optionally writes the mirror as a PPM (over the app's
+// background colour) with every report.
+// Build: g++ -std=c++17 -O2 -I.. CanvasViewer.cpp ../SharedCanvas.cpp ../SharedMemory.cpp -o canvas_viewer [-lrt]
+// Usage: canvas_viewer NAME [--ppm FILE]
+
+#include "SharedCanvas.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static bool writePpm(const char* path, const std::vector<std::uint8_t>& rgba, std::uint32_t w, std::uint32_t h) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    std::fprintf(f, "P6 %u %u 255\n", w, h);
+    static const unsigned bg[3] = { 15, 18, 22 };
+    std::vector<std::uint8_t> row(std::size_t(w) * 3);
+    for (std::uint32_t y = 0; y < h; ++y) {
+        for (std::uint32_t x = 0; x < w; ++x) {
+            const std::uint8_t* p = &rgba[(std::size_t(y) * w + x) * 4];
+            for (int c = 0; c < 3; ++c) row[x * 3 + c] = static_cast<std::uint8_t>((p[c] * p[3] + bg[c] * (255u - p[3]) + 127u) / 255u);
+        }
+        std::fwrite(row.data(), 1, row.size(), f);
+    }
+    return std::fclose(f) == 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s NAME [--ppm FILE]\n", argv[0]);
+        return 2;
+    }
+    const char* name = argv[1];
+    const char* ppm = nullptr;
+    for (int i = 2; i < argc; ++i)
+        if (!std::strcmp(argv[i], "--ppm") && i + 1 < argc) ppm = argv[++i];
+
+    SharedCanvasReader reader;
+    while (!reader.open(name)) {
+        std::fprintf(stderr, "waiting for canvas '%s'...\n", name);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    std::printf("canvas '%s': %u x %u\n", name, reader.width(), reader.height());
+
+    using clock = std::chrono::steady_clock;
+    std::vector<std::uint8_t> rgba;
+    std::uint64_t polls = 0, tiles = 0, lastGen = reader.generation(), lastTorn = 0;
+    auto windowStart = clock::now();
+
+    for (;;) {
+        const std::size_t n = reader.poll(rgba);
+        if (n == SharedCanvasReader::kReopen) {
+            // the app resized or quit: follow it to the new region
+            while (!reader.open(name)) {
+                std::fprintf(stderr, "waiting for canvas '%s'...\n", name);
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+            std::printf("canvas '%s': %u x %u\n", name, reader.width(), reader.height());
+            lastGen = reader.generation();
+            continue;
+        }
+        if (n) { tiles += n; ++polls; }
+        else std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+        const auto now = clock::now();
+        const double secs = std::chrono::duration<double>(now - windowStart).count();
+        if (secs >= 1.0) {
+            const double kb = tiles * canvasshm::kTileBytes / 1024.0;
+            std::printf("%6.1f gen/s  %8.0f tiles/s  %8.0f KB/s read  %6.1f tiles/copy  gen %llu  torn %llu (+%llu)\n",
+                (reader.generation() - lastGen) / secs, tiles / secs, kb / secs,
+                polls ? static_cast<double>(tiles) / polls : 0.0,
+                static_cast<unsigned long long>(reader.generation()),
+                static_cast<unsigned long long>(reader.torn()),
+                static_cast<unsigned long long>(reader.torn() - lastTorn));
+            std::fflush(stdout);
+            if (ppm && !rgba.empty() && !writePpm(ppm, rgba, reader.width(), reader.height()))
+                std::fprintf(stderr, "could not write %s\n", ppm);
+            lastGen = reader.generation();
+            lastTorn = reader.torn();
+            polls = tiles = 0;
+            windowStart = now;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+// StreamReader.cpp — follows the app's shared-memory sample stream (--stream NAME)
+// and reports throughput / dropped samples once a second.
+// Build: g++ -std=c++17 -O2 -I.. StreamReader.cpp ../SampleStream.cpp ../SharedMemory.cpp -o stream_reader [-lrt]
+// Usage: stream_reader NAME [--from-oldest] [--slow-us N]
+//   --slow-us N  sleep N microseconds per poll to simulate a slow consumer
+
+#include "SampleStream.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s NAME [--from-oldest] [--slow-us N]\n", argv[0]);
+        return 2;
+    }
+    const char* name = argv[1];
+    bool fromOldest = false;
+    long slowUs = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--from-oldest")) fromOldest = true;
+        else if (!std::strcmp(argv[i], "--slow-us") && i + 1 < argc) slowUs = std::atol(argv[++i]);
+    }
+
+    SampleStreamReader reader;
+    while (!reader.open(name, fromOldest)) {
+        std::fprintf(stderr, "waiting for stream '%s'...\n", name);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    using clock = std::chrono::steady_clock;
+    std::vector<stream::Sample> batch;
+    batch.reserve(4096);
+
+    std::uint64_t total = 0, windowCount = 0, lastDropped = 0;
+    stream::Sample last{};
+    auto windowStart = clock::now();
+
+    for (;;) {
+        batch.clear();
+        const std::size_t n = reader.poll(batch, 4096);
+        if (n) { last = batch.back(); total += n; windowCount += n; }
+
+        if (slowUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(slowUs));
+        else if (n == 0) std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+        const auto now = clock::now();
+        const double secs = std::chrono::duration<double>(now - windowStart).count();
+        if (secs >= 1.0) {
+            const std::uint64_t dropped = reader.dropped();
+            std::printf("%10.0f samples/s  total %llu  dropped %llu (+%llu)  lag %llu  t=%.3f pen=(%.1f, %.1f)\n",
+                windowCount / secs,
+                static_cast<unsigned long long>(total),
+                static_cast<unsigned long long>(dropped),
+                static_cast<unsigned long long>(dropped - lastDropped),
+                static_cast<unsigned long long>(reader.head() - reader.position()),
+                last.t, last.x, last.y);
+            std::fflush(stdout);
+            lastDropped = dropped;
+            windowCount = 0;
+            windowStart = now;
+        }
+    }
+}
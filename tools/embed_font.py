@@ -0,0 +1,17 @@
+#!/usr/bin/env python3
+"""Regenerates EmbeddedFont.inc (the HUD/help font as a byte list) for EmbeddedFont.cpp.
+
+Usage: python3 tools/embed_font.py [Assets/Fonts/CONSOLA.TTF] > EmbeddedFont.inc
+"""
+import os
+import sys
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'Assets/Fonts/CONSOLA.TTF'
+with open(path, 'rb') as f:
+    data = f.read()
+
+print('// EmbeddedFont.inc — %s, %d bytes.' % (os.path.basename(path), len(data)))
+print('// Generated by tools/embed_font.py; do not edit.')
+PER_LINE = 32
+for i in range(0, len(data), PER_LINE):
+    print(','.join(str(b) for b in data[i:i + PER_LINE]) + ',')
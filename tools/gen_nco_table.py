@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+"""Regenerates NcoSineTable.inc (quarter-wave sine, Q30) for Nco.cpp.
+
+Uses 50-digit decimal arithmetic so the table does not depend on any libm.
+Usage: python3 tools/gen_nco_table.py > NcoSineTable.inc
+"""
+from decimal import Decimal, getcontext
+
+getcontext().prec = 50
+SEGMENTS = 1024
+PI = Decimal('3.14159265358979323846264338327950288419716939937510')
+
+
+def dsin(x):
+    term = s = x
+    n = 1
+    while abs(term) > Decimal(10) ** -45:
+        term = -term * x * x / Decimal((2 * n) * (2 * n + 1))
+        s += term
+        n += 1
+    return s
+
+
+vals = [int((dsin(PI / 2 * i / SEGMENTS) * (1 << 30)).to_integral_value(rounding='ROUND_HALF_EVEN'))
+        for i in range(SEGMENTS + 1)]
+
+print('// NcoSineTable.inc — quarter-wave sine, 1024 segments, Q30 (1.0 = 1 << 30).')
+print('// Generated by tools/gen_nco_table.py with 50-digit decimal arithmetic, so every')
+print("// build uses the exact same integers regardless of the platform's libm.")
+for i in range(0, SEGMENTS + 1, 8):
+    print('    ' + ', '.join(str(v) for v in vals[i:i + 8]) + ',')